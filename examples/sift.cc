@@ -104,6 +104,7 @@ private:
   int yDistance;                                      //y distance between two consecutive nodes in grid topology
   double gridWidth;                           //Number of nodes on each line of grid
   bool pcap;                                          //enable disable pcap report files
+  std::string roadMap;                        // Edge list of the roads SiFT trajectories follow, empty for straight ones
   NodeContainer adhocNodes;
   NetDeviceContainer allDevices;
   Ipv4InterfaceContainer allInterfaces;
@@ -166,6 +167,7 @@ SiftTest::Configure (int argc, char **argv)
   cmd.AddValue ("packetSize", "The packet size", packetSize);
   cmd.AddValue ("txpDistance", "Specify node's transmit range, Default:250", txpDistance);
   cmd.AddValue ("pauseTime", "pauseTime for mobility model, Default: 100", pauseTime);
+  cmd.AddValue ("roadMap", "Edge list file of the roads SiFT trajectories follow, Default: none", roadMap);
 
   cmd.Parse (argc, argv);
 
@@ -398,6 +400,12 @@ SiftTest::InstallInternetStack ()
     case SIFT:
       internet.Install (adhocNodes);
       sift.SetNodes (adhocNodes);
+      if (!roadMap.empty ())
+        {
+          Ptr<sift::SiftRoadMap> map = CreateObject<sift::SiftRoadMap> ();
+          map->Load (roadMap);
+          sift.SetRoadMap (map);
+        }
       siftMain.Install (sift, adhocNodes);
       break;
 
@@ -424,7 +432,8 @@ SiftTest::InstallInternetStack ()
     }
   //NS_LOG_INFO ("assigning ip address");
   Ipv4AddressHelper address;
-  address.SetBase ("10.1.1.0", "255.255.255.0");
+  // A /16 leaves room for up to 65534 nodes
+  address.SetBase ("10.1.0.0", "255.255.0.0");
   //Ipv4InterfaceContainer allInterfaces;
   allInterfaces = address.Assign (allDevices);
 
@@ -272,7 +272,8 @@ SiftExample::InstallInternetStack ()
 
   //NS_LOG_INFO ("assigning ip address");
   Ipv4AddressHelper address;
-  address.SetBase ("10.1.1.0", "255.255.255.0");
+  // A /16 leaves room for up to 65534 nodes
+  address.SetBase ("10.1.0.0", "255.255.0.0");
   //Ipv4InterfaceContainer allInterfaces;
   allInterfaces = address.Assign (allDevices);
 
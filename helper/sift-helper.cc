@@ -50,10 +50,13 @@ SiftHelper::SiftHelper ()
 {
   NS_LOG_FUNCTION (this);
   m_agentFactory.SetTypeId ("ns3::sift::SiftRouting");
+  m_registry = CreateObject<sift::SiftNodeRegistry> ();
+  m_oracle = CreateObject<sift::SiftPositionOracle> ();
 }
 
 SiftHelper::SiftHelper (const SiftHelper &o)
-  : m_agentFactory (o.m_agentFactory), m_nodes (o.m_nodes)
+  : m_agentFactory (o.m_agentFactory), m_registry (o.m_registry),
+    m_oracle (o.m_oracle), m_roadMap (o.m_roadMap)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -84,12 +87,12 @@ SiftHelper::Create (Ptr<Node> node) const
   Ptr<Icmpv4L4Protocol> icmp = node->GetObject<Icmpv4L4Protocol> ();
   icmp->SetDownTarget (MakeCallback (&sift::SiftRouting::Send, agent));
 
-  for (uint32_t j = 0; j < m_nodes.GetN (); j++)
-  {
-    NS_ASSERT (m_nodes.Get(j) != 0);
-    agent->AddNode (m_nodes.Get (j));
-  }
-
+  agent->SetNodeRegistry (m_registry);
+  agent->SetPositionOracle (m_oracle);
+  if (m_roadMap != 0)
+    {
+      agent->SetWaypointCallback (MakeCallback (&sift::SiftRoadMap::GetWaypoints, m_roadMap));
+    }
   node->AggregateObject (agent);
   return agent;
 }
@@ -103,7 +106,39 @@ SiftHelper::Set (std::string name, const AttributeValue &value)
 void
 SiftHelper::SetNodes (NodeContainer &nodes)
 {
-  m_nodes.Add(nodes);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      m_oracle->AddNode (*i);
+    }
+}
+
+void
+SiftHelper::SetRoadMap (Ptr<sift::SiftRoadMap> roadMap)
+{
+  NS_LOG_FUNCTION (this << roadMap);
+  m_roadMap = roadMap;
+}
+
+void
+SiftHelper::UpdateNodeRegistry (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_registry->Rebuild ();
+}
+
+int64_t
+SiftHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<sift::SiftRouting> sift = (*i)->GetObject<sift::SiftRouting> ();
+      if (sift != 0)
+        {
+          currentStream += sift->AssignStreams (currentStream);
+        }
+    }
+  return (currentStream - stream);
 }
 
 
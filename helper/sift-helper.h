@@ -35,6 +35,7 @@
 #include "ns3/node-container.h"
 #include "ns3/object-factory.h"
 #include "ns3/sift-routing.h"
+#include "ns3/sift-road-map.h"
 #include "ns3/node.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/tcp-l4-protocol.h"
@@ -74,6 +75,28 @@ public:
    */
   void Set (std::string name, const AttributeValue &value);
   void SetNodes (NodeContainer &nodes);
+  /**
+   * \param roadMap road graph the sources plan their waypoints on, shared by all the agents
+   * created by this helper and its copies; without one the trajectories are straight lines
+   */
+  void SetRoadMap (Ptr<ns3::sift::SiftRoadMap> roadMap);
+  /**
+   * \brief Rebuild the address table shared by the agents of this helper.
+   *
+   * Call it after addresses are assigned during the simulation. Addresses looked up
+   * while unknown are only found again after this call.
+   */
+  void UpdateNodeRegistry (void);
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the SIFT agents of the given nodes.
+   *
+   * \param c NodeContainer of the set of nodes for which SIFT
+   *          should be modified to use a fixed stream
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this helper
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
 private:
   /**
    * \internal
@@ -82,7 +105,9 @@ private:
    */
   SiftHelper & operator = (const SiftHelper &o);
   ObjectFactory m_agentFactory;
-  NodeContainer m_nodes;
+  Ptr<ns3::sift::SiftNodeRegistry> m_registry; ///< shared by the agents created by this helper and its copies
+  Ptr<ns3::sift::SiftPositionOracle> m_oracle; ///< shared by the agents created by this helper and its copies
+  Ptr<ns3::sift::SiftRoadMap> m_roadMap;       ///< shared by the agents created by this helper and its copies, if set
 };
 
 } // namespace ns3
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ */
+
+/// \brief	Contention delay policies of the SiFT relays.
+
+#ifndef SIFT_DELAY_POLICY_H
+#define SIFT_DELAY_POLICY_H
+
+#include <stdint.h>
+#include <algorithm>
+
+namespace ns3 {
+namespace sift {
+
+/**
+ * \brief What a relay knows about itself when it sets its contention timer.
+ */
+struct SiftDelayContext
+{
+  double dTrajectory;   ///< distance of the relay from the trajectory, in meters
+  double dLastSource;   ///< distance of the relay from the last sender, in meters
+  double progress;      ///< advance of the relay over the last sender along the active segment, in meters
+  double range;         ///< distance at which a relay still takes part, in meters
+  uint32_t neighbors;   ///< number of known nodes within range of the relay
+  uint32_t referenceNeighbors; ///< number of neighbors at which the density policy matches the ratio policy
+  double minScale;      ///< smallest scale of the weight by the density policy
+  double maxScale;      ///< largest scale of the weight by the density policy
+};
+
+/**
+ * \brief Base of the contention delay policies.
+ *
+ * A policy gives the weight of a relay, and the relay waits
+ * transmissionTime + alpha * weight before it forwards the packet. The relay with the
+ * smallest weight forwards first. Each policy implements
+ * double DoGetWeight (const SiftDelayContext &context) const, which is reached
+ * without a virtual call, so it is inlined in SiftRouting::Receive.
+ * A policy that sets NEEDS_NEIGHBORS to true gets SiftDelayContext::neighbors filled;
+ * the others leave the geographic set alone.
+ */
+template <class Policy>
+class SiftDelayPolicy
+{
+public:
+  /**
+   * \param context the position of the relay
+   * \returns the weight of the relay, 0 or more
+   */
+  double GetWeight (const SiftDelayContext &context) const
+  {
+    return static_cast<const Policy *> (this)->DoGetWeight (context);
+  }
+  /**
+   * \param context the position of the relay
+   * \param transmissionTime the time of one transmission, in seconds
+   * \param alpha scale of the weight, in seconds
+   * \returns the time the relay waits before it forwards the packet, in seconds
+   */
+  double GetDelay (const SiftDelayContext &context, double transmissionTime, double alpha) const
+  {
+    return transmissionTime + alpha * GetWeight (context);
+  }
+};
+
+/**
+ * \brief The SiFT formula: distance from the trajectory over distance from the last sender.
+ *
+ * Relays close to the trajectory and far from the last sender forward first.
+ */
+class TrajectoryRatioDelay : public SiftDelayPolicy<TrajectoryRatioDelay>
+{
+public:
+  static const bool NEEDS_NEIGHBORS = false;
+  double DoGetWeight (const SiftDelayContext &context) const
+  {
+    // A relay on the trajectory counts as 1 m away, one at the last sender as 1 m from it
+    return std::max (context.dTrajectory, 1.0) / std::max (context.dLastSource, 1.0);
+  }
+};
+
+/**
+ * \brief Relays that bring the packet farthest along the trajectory forward first.
+ *
+ * The weight goes from 0, for an advance of the whole range, to 1 for no advance at all
+ * or a relay behind the last sender.
+ */
+class ProgressDelay : public SiftDelayPolicy<ProgressDelay>
+{
+public:
+  static const bool NEEDS_NEIGHBORS = false;
+  double DoGetWeight (const SiftDelayContext &context) const
+  {
+    return std::min (1.0, std::max (0.0, 1 - context.progress / std::max (context.range, 1.0)));
+  }
+};
+
+/**
+ * \brief Relays closest to the trajectory forward first, wherever the last sender is.
+ *
+ * The weight goes from 0 on the trajectory to 1 at the edge of the range.
+ */
+class DistanceOnlyDelay : public SiftDelayPolicy<DistanceOnlyDelay>
+{
+public:
+  static const bool NEEDS_NEIGHBORS = false;
+  double DoGetWeight (const SiftDelayContext &context) const
+  {
+    return std::min (1.0, context.dTrajectory / std::max (context.range, 1.0));
+  }
+};
+
+/**
+ * \brief The SiFT formula, scaled by the number of neighbors of the relay.
+ *
+ * With more neighbors than referenceNeighbors, more relays contend and their timers are
+ * spread over a longer window. With fewer, the packet waits less at each hop. The scale
+ * stays between minScale and maxScale.
+ */
+class DensityAdaptiveDelay : public SiftDelayPolicy<DensityAdaptiveDelay>
+{
+public:
+  static const bool NEEDS_NEIGHBORS = true;
+  double DoGetWeight (const SiftDelayContext &context) const
+  {
+    double scale = static_cast<double> (context.neighbors) / std::max<uint32_t> (context.referenceNeighbors, 1);
+    scale = std::min (context.maxScale, std::max (context.minScale, scale));
+    return scale * TrajectoryRatioDelay ().DoGetWeight (context);
+  }
+};
+
+} // namespace sift
+} // namespace ns3
+
+#endif /* SIFT_DELAY_POLICY_H */
@@ -0,0 +1,468 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ *
+ * James P.G. Sterbenz <jpgs@ittc.ku.edu>, director
+ * ResiliNets Research Group  http://wiki.ittc.ku.edu/resilinets
+ * Information and Telecommunication Technology Center (ITTC)
+ * and Department of Electrical Engineering and Computer Science
+ * The University of Kansas Lawrence, KS USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "sift-duplicate-cache.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+namespace sift {
+
+NS_LOG_COMPONENT_DEFINE ("SiftDuplicateCache");
+
+SiftDuplicateCache::SiftDuplicateCache ()
+  : m_lifetime (Seconds (3))
+{
+}
+
+void
+SiftDuplicateCache::SetLifetime (Time lifetime)
+{
+  m_lifetime = lifetime;
+}
+
+Time
+SiftDuplicateCache::GetLifetime () const
+{
+  return m_lifetime;
+}
+
+bool
+SiftDuplicateCache::Lookup (const SiftPacketKey &key)
+{
+  NS_LOG_FUNCTION (this << key);
+  Purge ();
+  return (m_keys.find (key) != m_keys.end ());
+}
+
+void
+SiftDuplicateCache::Insert (const SiftPacketKey &key)
+{
+  NS_LOG_FUNCTION (this << key);
+  Purge ();
+  Time now = Simulator::Now ();
+  m_keys[key] = now;
+  m_expiry.push_back (std::make_pair (key, now));
+}
+
+uint32_t
+SiftDuplicateCache::GetSize ()
+{
+  Purge ();
+  return m_keys.size ();
+}
+
+void
+SiftDuplicateCache::Clear ()
+{
+  m_keys.clear ();
+  m_expiry.clear ();
+}
+
+void
+SiftDuplicateCache::Print (std::ostream &os)
+{
+  Purge ();
+  for (KeyMap::const_iterator it = m_keys.begin (); it != m_keys.end (); ++it)
+    {
+      os << it->first << "=>" << it->second << '\n';
+    }
+}
+
+void
+SiftDuplicateCache::Purge ()
+{
+  Time now = Simulator::Now ();
+  while (!m_expiry.empty () && now - m_expiry.front ().second >= m_lifetime)
+    {
+      KeyMap::iterator it = m_keys.find (m_expiry.front ().first);
+      // A key that was refreshed later has a newer entry further back in the queue
+      if (it != m_keys.end () && it->second == m_expiry.front ().second)
+        {
+          NS_LOG_DEBUG ("One expired packet was removed from the duplicate cache " << it->first);
+          m_keys.erase (it);
+        }
+      m_expiry.pop_front ();
+    }
+}
+
+SiftSequenceWindow::SiftSequenceWindow ()
+  : m_lifetime (Seconds (3))
+{
+}
+
+void
+SiftSequenceWindow::SetLifetime (Time lifetime)
+{
+  m_lifetime = lifetime;
+}
+
+Time
+SiftSequenceWindow::GetLifetime () const
+{
+  return m_lifetime;
+}
+
+bool
+SiftSequenceWindow::Lookup (const SiftPacketKey &key) const
+{
+  NS_LOG_FUNCTION (this << key);
+  WindowMap::const_iterator it = m_windows.find (key.source);
+  if (it == m_windows.end () || Simulator::Now () - it->second.updated >= m_lifetime)
+    {
+      return false;
+    }
+  // Signed distance in serial number arithmetic, correct across the wrap of the counter
+  int16_t diff = static_cast<int16_t> (key.seqNo - it->second.highest);
+  if (diff > 0)
+    {
+      return false;
+    }
+  uint32_t age = static_cast<uint32_t> (-static_cast<int32_t> (diff));
+  if (age >= WINDOW_SIZE)
+    {
+      NS_LOG_DEBUG ("Seq no " << key.seqNo << " of " << key.source << " is older than the window");
+      return true;
+    }
+  return ((it->second.bitmap >> age) & 1) != 0;
+}
+
+void
+SiftSequenceWindow::Insert (const SiftPacketKey &key)
+{
+  NS_LOG_FUNCTION (this << key);
+  Time now = Simulator::Now ();
+  if (now - m_lastPurge >= m_lifetime)
+    {
+      Purge ();
+    }
+  WindowMap::iterator it = m_windows.find (key.source);
+  if (it == m_windows.end () || now - it->second.updated >= m_lifetime)
+    {
+      // A new origin, or one silent for so long that its window says nothing about the
+      // sequence numbers it uses now
+      Window window;
+      window.highest = key.seqNo;
+      window.bitmap = 1;
+      window.updated = now;
+      m_windows[key.source] = window;
+      return;
+    }
+  Window &window = it->second;
+  window.updated = now;
+  int16_t diff = static_cast<int16_t> (key.seqNo - window.highest);
+  if (diff > 0)
+    {
+      // Slide the window forward, the new packet becomes the highest one
+      window.bitmap = (diff >= WINDOW_SIZE) ? 1 : ((window.bitmap << diff) | 1);
+      window.highest = key.seqNo;
+    }
+  else
+    {
+      uint32_t age = static_cast<uint32_t> (-static_cast<int32_t> (diff));
+      if (age < WINDOW_SIZE)
+        {
+          window.bitmap |= (static_cast<uint64_t> (1) << age);
+        }
+    }
+}
+
+uint32_t
+SiftSequenceWindow::GetSize ()
+{
+  Purge ();
+  return m_windows.size ();
+}
+
+void
+SiftSequenceWindow::Clear ()
+{
+  m_windows.clear ();
+}
+
+void
+SiftSequenceWindow::Purge ()
+{
+  Time now = Simulator::Now ();
+  for (WindowMap::iterator it = m_windows.begin (); it != m_windows.end (); )
+    {
+      if (now - it->second.updated >= m_lifetime)
+        {
+          NS_LOG_DEBUG ("The window of " << it->first << " was removed, no packet of it for " << m_lifetime);
+          it = m_windows.erase (it);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+  m_lastPurge = now;
+}
+
+void
+SiftSequenceWindow::Print (std::ostream &os) const
+{
+  for (WindowMap::const_iterator it = m_windows.begin (); it != m_windows.end (); ++it)
+    {
+      os << it->first << "=> highest seq no " << it->second.highest
+         << " bitmap 0x" << std::hex << it->second.bitmap << std::dec << '\n';
+    }
+}
+
+SiftBloomFilter::SiftBloomFilter ()
+  : m_bits (0),
+    m_hashes (0),
+    m_inserted (0),
+    m_lifetime (Seconds (3)),
+    m_capacity (4096),
+    m_falsePositiveRate (0.001)
+{
+}
+
+void
+SiftBloomFilter::SetLifetime (Time lifetime)
+{
+  m_lifetime = lifetime;
+}
+
+Time
+SiftBloomFilter::GetLifetime () const
+{
+  return m_lifetime;
+}
+
+void
+SiftBloomFilter::SetCapacity (uint32_t capacity)
+{
+  m_capacity = capacity;
+  // Resized on next use
+  Clear ();
+}
+
+uint32_t
+SiftBloomFilter::GetCapacity () const
+{
+  return m_capacity;
+}
+
+void
+SiftBloomFilter::SetFalsePositiveRate (double rate)
+{
+  m_falsePositiveRate = rate;
+  Clear ();
+}
+
+double
+SiftBloomFilter::GetFalsePositiveRate () const
+{
+  return m_falsePositiveRate;
+}
+
+void
+SiftBloomFilter::Configure ()
+{
+  NS_ASSERT_MSG (m_capacity > 0, "The capacity of a Bloom filter generation must be positive");
+  NS_ASSERT_MSG (m_falsePositiveRate > 0 && m_falsePositiveRate < 1, "The false positive rate must be in (0, 1)");
+  // m = -n ln(p) / ln(2)^2 and k = (m / n) ln(2)
+  double bits = std::ceil (-(m_capacity * std::log (m_falsePositiveRate)) / (std::log (2.0) * std::log (2.0)));
+  m_bits = std::max<uint32_t> (64, static_cast<uint32_t> (bits));
+  m_bits = (m_bits + 63) / 64 * 64;
+  m_hashes = std::max<uint32_t> (1, static_cast<uint32_t> (std::floor (m_bits * std::log (2.0) / m_capacity + 0.5)));
+  m_current.assign (m_bits / 64, 0);
+  m_previous.assign (m_bits / 64, 0);
+  m_highest.clear ();
+  m_previousHighest.clear ();
+  m_inserted = 0;
+  m_generationStart = Simulator::Now ();
+  NS_LOG_DEBUG ("Bloom filter generation of " << m_bits << " bits with " << m_hashes << " hashes");
+}
+
+void
+SiftBloomFilter::Rotate ()
+{
+  if (m_current.empty ())
+    {
+      Configure ();
+      return;
+    }
+  // Each generation covers half the lifetime, so a packet is kept between lifetime/2 and
+  // lifetime, unless Insert retires a full generation first
+  if (Simulator::Now () - m_generationStart >= Seconds (m_lifetime.GetSeconds () / 2))
+    {
+      StartGeneration ();
+    }
+}
+
+void
+SiftBloomFilter::StartGeneration ()
+{
+  NS_LOG_DEBUG ("Starting a new Bloom filter generation after " << m_inserted << " packets");
+  m_previous.swap (m_current);
+  m_current.assign (m_bits / 64, 0);
+  // Origins last recorded two generations ago have no packet left in either filter
+  m_previousHighest.swap (m_highest);
+  m_highest.clear ();
+  m_inserted = 0;
+  m_generationStart = Simulator::Now ();
+}
+
+bool
+SiftBloomFilter::FindHighest (Ipv4Address origin, uint16_t &highest) const
+{
+  HighestSeqMap::const_iterator it = m_highest.find (origin);
+  if (it != m_highest.end ())
+    {
+      highest = it->second;
+      return true;
+    }
+  it = m_previousHighest.find (origin);
+  if (it != m_previousHighest.end ())
+    {
+      highest = it->second;
+      return true;
+    }
+  return false;
+}
+
+void
+SiftBloomFilter::Hash (const SiftPacketKey &key, uint64_t &h1, uint64_t &h2)
+{
+  // splitmix64 finalizer over the packed key
+  uint64_t h = (static_cast<uint64_t> (key.source.Get ()) << 32) | key.destination.Get ();
+  h ^= static_cast<uint64_t> (key.seqNo) * 0x9E3779B97F4A7C15ULL;
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h = h ^ (h >> 31);
+  h1 = h & 0xFFFFFFFFULL;
+  h2 = (h >> 32) | 1;
+}
+
+bool
+SiftBloomFilter::Contains (const std::vector<uint64_t> &bits, uint64_t h1, uint64_t h2) const
+{
+  for (uint32_t i = 0; i < m_hashes; ++i)
+    {
+      uint32_t bit = static_cast<uint32_t> ((h1 + i * h2) % m_bits);
+      if (((bits[bit >> 6] >> (bit & 63)) & 1) == 0)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+SiftBloomFilter::Lookup (const SiftPacketKey &key, bool &falsePositive)
+{
+  NS_LOG_FUNCTION (this << key);
+  falsePositive = false;
+  Rotate ();
+  uint64_t h1, h2;
+  Hash (key, h1, h2);
+  if (!Contains (m_current, h1, h2) && !Contains (m_previous, h1, h2))
+    {
+      return false;
+    }
+  uint16_t highest;
+  if (!FindHighest (key.source, highest) || static_cast<int16_t> (key.seqNo - highest) > 0)
+    {
+      NS_LOG_DEBUG ("Bloom filter matched a packet that was never recorded " << key);
+      falsePositive = true;
+      return false;
+    }
+  return true;
+}
+
+bool
+SiftBloomFilter::Insert (const SiftPacketKey &key)
+{
+  NS_LOG_FUNCTION (this << key);
+  Rotate ();
+  uint64_t h1, h2;
+  Hash (key, h1, h2);
+  for (uint32_t i = 0; i < m_hashes; ++i)
+    {
+      uint32_t bit = static_cast<uint32_t> ((h1 + i * h2) % m_bits);
+      m_current[bit >> 6] |= (static_cast<uint64_t> (1) << (bit & 63));
+    }
+  m_inserted++;
+  uint16_t highest;
+  if (!FindHighest (key.source, highest) || static_cast<int16_t> (key.seqNo - highest) > 0)
+    {
+      highest = key.seqNo;
+    }
+  m_highest[key.source] = highest;
+  if (m_inserted >= m_capacity)
+    {
+      // More packets than the capacity in half the lifetime: the generation is retired early
+      // so that the false positive rate holds, at the cost of a shorter memory
+      StartGeneration ();
+      return true;
+    }
+  return false;
+}
+
+uint32_t
+SiftBloomFilter::GetBits ()
+{
+  if (m_current.empty ())
+    {
+      Configure ();
+    }
+  return m_bits;
+}
+
+uint32_t
+SiftBloomFilter::GetHashes ()
+{
+  if (m_current.empty ())
+    {
+      Configure ();
+    }
+  return m_hashes;
+}
+
+void
+SiftBloomFilter::Clear ()
+{
+  m_current.clear ();
+  m_previous.clear ();
+  m_highest.clear ();
+  m_previousHighest.clear ();
+  m_inserted = 0;
+}
+
+void
+SiftBloomFilter::Print (std::ostream &os)
+{
+  os << "Bloom filter: " << GetBits () << " bits per generation, " << GetHashes () << " hashes, "
+     << m_inserted << " packets in the current generation, " << m_highest.size () << " origins in the current generation\n";
+}
+
+}  /* namespace sift */
+}  /* namespace ns3 */
@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ *
+ * James P.G. Sterbenz <jpgs@ittc.ku.edu>, director
+ * ResiliNets Research Group  http://wiki.ittc.ku.edu/resilinets
+ * Information and Telecommunication Technology Center (ITTC)
+ * and Department of Electrical Engineering and Computer Science
+ * The University of Kansas Lawrence, KS USA.
+ */
+
+#ifndef SIFT_DUPLICATE_CACHE_H
+#define SIFT_DUPLICATE_CACHE_H
+
+#include <deque>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "sift-repository.h"
+
+namespace ns3 {
+namespace sift {
+
+/**
+ * \class SiftDuplicateCache
+ * \brief Remembers which SiFT packets a node has already seen.
+ *
+ * Entries are indexed by the (source, destination, seq no) key of the packet,
+ * so lookup and insert are constant time. Only the key and the time it was
+ * recorded are kept. Expired entries are reclaimed from the front of an
+ * insertion-ordered queue, which never requires a sweep of the whole cache.
+ */
+class SiftDuplicateCache
+{
+public:
+  SiftDuplicateCache ();
+  /**
+   * \brief Set how long a packet is remembered after it was last recorded.
+   * \param lifetime the lifetime of an entry
+   */
+  void SetLifetime (Time lifetime);
+  /**
+   * \brief Get the lifetime of an entry.
+   * \return the lifetime
+   */
+  Time GetLifetime () const;
+  /**
+   * \brief Check whether a packet was recorded within the lifetime.
+   * \param key the key of the packet
+   * \return true if the packet is a duplicate
+   */
+  bool Lookup (const SiftPacketKey &key);
+  /**
+   * \brief Record a packet, or refresh its time stamp if it is already known.
+   * \param key the key of the packet
+   */
+  void Insert (const SiftPacketKey &key);
+  /**
+   * \brief Get the number of packets currently remembered.
+   * \return the number of live entries
+   */
+  uint32_t GetSize ();
+  /**
+   * \brief Forget every packet.
+   */
+  void Clear ();
+  /**
+   * \brief Print the content of the cache.
+   * \param os output stream
+   */
+  void Print (std::ostream &os);
+
+private:
+  /// Remove the entries whose lifetime has passed
+  void Purge ();
+
+  typedef std::unordered_map<SiftPacketKey, Time, SiftPacketKeyHash> KeyMap;
+  typedef std::deque<std::pair<SiftPacketKey, Time> > ExpiryQueue;
+
+  KeyMap m_keys;            ///< key -> time the packet was last recorded
+  ExpiryQueue m_expiry;     ///< keys in the order they were recorded
+  Time m_lifetime;          ///< how long a packet is remembered
+};
+
+/**
+ * \class SiftSequenceWindow
+ * \brief Duplicate detection with one sliding sequence window per origin.
+ *
+ * Every origin stamps its packets with an increasing 16-bit sequence number,
+ * so, as in an anti-replay window, it is enough to remember the highest
+ * sequence number seen from each origin plus a bitmap of the WINDOW_SIZE
+ * numbers below it. Memory is a few bytes per active origin whatever the
+ * traffic. Sequence numbers are compared in serial number arithmetic, so the
+ * window keeps working when the counter wraps around. A packet older than
+ * the window is reported as a duplicate.
+ *
+ * The window of an origin not heard for the lifetime is forgotten, and the
+ * next packet of that origin starts a new window. A node that missed half the
+ * sequence space from an origin, during a partition for instance, would
+ * otherwise take every new packet of it for an old one. Stale origins are
+ * dropped at most once per lifetime, when a packet is recorded.
+ */
+class SiftSequenceWindow
+{
+public:
+  /// Number of sequence numbers tracked below the highest one of an origin
+  static const uint16_t WINDOW_SIZE = 64;
+
+  SiftSequenceWindow ();
+  /**
+   * \brief Set how long the window of an origin is kept without a new packet.
+   * \param lifetime the lifetime of a window
+   */
+  void SetLifetime (Time lifetime);
+  /**
+   * \brief Get how long the window of an origin is kept without a new packet.
+   * \return the lifetime of a window
+   */
+  Time GetLifetime () const;
+  /**
+   * \brief Check whether a packet was already recorded.
+   * \param key the key of the packet, only the source and seq no are used
+   * \return true if the packet is a duplicate
+   */
+  bool Lookup (const SiftPacketKey &key) const;
+  /**
+   * \brief Record a packet in the window of its origin.
+   * \param key the key of the packet, only the source and seq no are used
+   */
+  void Insert (const SiftPacketKey &key);
+  /**
+   * \brief Get the number of origins that have a window.
+   * \return the number of origins heard within the lifetime
+   */
+  uint32_t GetSize ();
+  /**
+   * \brief Forget every origin.
+   */
+  void Clear ();
+  /**
+   * \brief Print the window of each origin.
+   * \param os output stream
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /// The window of one origin
+  struct Window
+  {
+    uint16_t highest;   ///< highest seq no seen from the origin
+    uint64_t bitmap;    ///< bit i is set if seq no (highest - i) was seen
+    Time updated;       ///< when the last packet of the origin was recorded
+  };
+  typedef std::unordered_map<Ipv4Address, Window, Ipv4AddressHash> WindowMap;
+
+  /**
+   * \brief Forget the origins not heard within the lifetime.
+   */
+  void Purge ();
+
+  WindowMap m_windows;  ///< origin -> window
+  Time m_lifetime;      ///< time an origin is remembered without a new packet
+  Time m_lastPurge;     ///< last time stale origins were dropped
+};
+
+/**
+ * \class SiftBloomFilter
+ * \brief Duplicate detection with a bounded memory budget.
+ *
+ * Two Bloom filter generations are kept. Packets are recorded in the current
+ * one, and both are checked. When the current generation gets older than half
+ * the lifetime, or holds as many packets as it was sized for, the older
+ * generation is dropped and an empty one takes its place. A packet is
+ * remembered for at least half the lifetime only while fewer packets than the
+ * capacity are recorded in half the lifetime. Above that rate a full generation
+ * is retired early, Insert reports it, and a packet is only remembered for the
+ * last capacity to twice the capacity packets.
+ *
+ * The filter also keeps the highest sequence number recorded from each origin
+ * during the current and the previous generation (two bytes per origin heard in
+ * that time). An origin is forgotten together with the last generation that
+ * holds its packets. A hit for an unknown origin, or for a sequence number newer
+ * than everything seen from that origin, can only be a false positive. Such a
+ * hit is reported through the falsePositive flag of Lookup and the packet is
+ * accepted. False positives on older sequence numbers cannot be told apart and
+ * are dropped as duplicates.
+ */
+class SiftBloomFilter
+{
+public:
+  SiftBloomFilter ();
+  /**
+   * \brief Set how long a packet is remembered.
+   * \param lifetime the lifetime of an entry
+   */
+  void SetLifetime (Time lifetime);
+  /**
+   * \brief Get how long a packet is remembered.
+   * \return the lifetime
+   */
+  Time GetLifetime () const;
+  /**
+   * \brief Set the number of packets one generation is sized for.
+   * \param capacity the capacity of a generation
+   */
+  void SetCapacity (uint32_t capacity);
+  /**
+   * \brief Get the number of packets one generation is sized for.
+   * \return the capacity
+   */
+  uint32_t GetCapacity () const;
+  /**
+   * \brief Set the target false positive rate of a full generation.
+   * \param rate the false positive rate, between 0 and 1
+   */
+  void SetFalsePositiveRate (double rate);
+  /**
+   * \brief Get the target false positive rate of a full generation.
+   * \return the false positive rate
+   */
+  double GetFalsePositiveRate () const;
+  /**
+   * \brief Check whether a packet was already recorded.
+   * \param key the key of the packet
+   * \param falsePositive set to true if the filter matched but the packet cannot have been recorded
+   * \return true if the packet is a duplicate
+   */
+  bool Lookup (const SiftPacketKey &key, bool &falsePositive);
+  /**
+   * \brief Record a packet.
+   * \param key the key of the packet
+   * \return true if the packet filled the current generation, which was then
+   * retired before half the lifetime
+   */
+  bool Insert (const SiftPacketKey &key);
+  /**
+   * \brief Get the size of one generation.
+   * \return the number of bits of one generation
+   */
+  uint32_t GetBits ();
+  /**
+   * \brief Get the number of hash functions.
+   * \return the number of bits set per packet
+   */
+  uint32_t GetHashes ();
+  /**
+   * \brief Forget every packet.
+   */
+  void Clear ();
+  /**
+   * \brief Print the state of the filter.
+   * \param os output stream
+   */
+  void Print (std::ostream &os);
+
+private:
+  /// Size the generations from the capacity and the false positive rate
+  void Configure ();
+  /// Start a new generation if the current one is older than half the lifetime
+  void Rotate ();
+  /// Retire the previous generation and start an empty one
+  void StartGeneration ();
+  /// Highest seq no recorded from an origin in either generation, false if none
+  bool FindHighest (Ipv4Address origin, uint16_t &highest) const;
+  /// Check the k bits of a packet in one generation
+  bool Contains (const std::vector<uint64_t> &bits, uint64_t h1, uint64_t h2) const;
+  /// Hash the packet key into the two values used for double hashing
+  static void Hash (const SiftPacketKey &key, uint64_t &h1, uint64_t &h2);
+
+  typedef std::unordered_map<Ipv4Address, uint16_t, Ipv4AddressHash> HighestSeqMap;
+
+  std::vector<uint64_t> m_current;      ///< generation new packets are recorded in
+  std::vector<uint64_t> m_previous;     ///< older generation, only checked
+  uint32_t m_bits;                      ///< bits of one generation
+  uint32_t m_hashes;                    ///< bits set per packet
+  uint32_t m_inserted;                  ///< packets recorded in the current generation
+  Time m_generationStart;               ///< when the current generation was started
+  Time m_lifetime;                      ///< how long a packet is remembered
+  uint32_t m_capacity;                  ///< packets a generation is sized for
+  double m_falsePositiveRate;           ///< target false positive rate of a full generation
+  HighestSeqMap m_highest;              ///< highest seq no recorded from each origin in the current generation
+  HighestSeqMap m_previousHighest;      ///< highest seq no recorded from each origin in the previous generation
+};
+
+}  /* namespace sift */
+}  /* namespace ns3 */
+
+#endif /* SIFT_DUPLICATE_CACHE_H */
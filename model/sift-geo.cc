@@ -28,7 +28,10 @@
 ///
 
 #include "sift-geo.h"
+#include "sift-geometry.h"
 #include <map>
+#include <cmath>
+#include <algorithm>
 #include "ns3/log.h"
 
 
@@ -37,102 +40,111 @@ namespace sift {
 
 NS_LOG_COMPONENT_DEFINE ("SiftGeo");
 
+/// slot that is not in the grid, such as an erased tuple
+static const uint64_t NO_CELL = ~static_cast<uint64_t> (0);
+
 SiftGeo::SiftGeo()
+  : m_cellSize (250),
+    m_arraysEnabled (false)
 {
 }
 
 GeographicTuple*
 SiftGeo::FindGeographicTuple (Ipv4Address const &mainAddr)
 {
-    NS_LOG_FUNCTION(this << mainAddr);
-	for (GeographicSet::iterator it = m_geographicSet.begin ();
-       it != m_geographicSet.end (); it++)
+  NS_LOG_FUNCTION (this << mainAddr);
+  GeographicIndex::const_iterator it = m_geographicIndex.find (mainAddr);
+  if (it == m_geographicIndex.end ())
     {
-      if (it->nodeAddr == mainAddr)
-        {
-          return &(*it);
-        }
+      return NULL;
     }
-  return NULL;
+  return &m_geographicSet[it->second];
 }
 
 void
 SiftGeo::InsertGeographicTuple (GeographicTuple const &tuple, bool &needTriggerUpdate)
 {
-	NS_LOG_FUNCTION(this << tuple);
-	for (GeographicSet::iterator it = m_geographicSet.begin ();
-       it != m_geographicSet.end (); it++)
+  NS_LOG_FUNCTION (this << tuple);
+  GeographicTuple *it = FindGeographicTuple (tuple.nodeAddr);
+  if (it != NULL)
     {
-      if (it->nodeAddr == tuple.nodeAddr)
+      // Update it
+      /*
+       * If there is any change in velocity components then that means this should be updated to other nodes
+       * as a triggered update. Else they can accurately calculate the co ordinates based on the last
+       * known position.
+       */
+      NS_LOG_DEBUG ("Existing Values: Node:" << it->nodeAddr << " - Position X:" << it->xcoord << " Y:" << it->ycoord
+                                             << " Z:" << it->zcoord << " Velocity X:" << it->xvelocity
+                                             << " Y:" << it->yvelocity << " Z:" << it->zvelocity);
+      if (tuple.xvelocity != it->xvelocity || tuple.yvelocity != it->yvelocity || tuple.zvelocity != it->zvelocity)
         {
-          // Update it
-          /*
-           * If there is any change in velocity components then that means this should be updated to other nodes
-           * as a triggered update. Else they can accurately calculate the co ordinates based on the last
-           * known position.
-           */
-          NS_LOG_DEBUG ("Existing Values: Node:" << it->nodeAddr << " - Position X:" << it->xcoord << " Y:" << it->ycoord
-                                                 << " Z:" << it->zcoord << " Velocity X:" << it->xvelocity
-                                                 << " Y:" << it->yvelocity << " Z:" << it->zvelocity);
-          if (tuple.xvelocity != it->xvelocity || tuple.yvelocity != it->yvelocity || tuple.zvelocity != it->zvelocity)
-            {
-              NS_LOG_DEBUG ("Velocity vector is changed. Need to send trigger update");
-              it->isChanged = true;
-              needTriggerUpdate = true;
-            }
-          //we should not replace *it with tuple but rather replace the values as the tuple might as well
-          //have link information associated with it and if replaced, that info will be lost.
-          it->xcoord = tuple.xcoord;
-          it->ycoord = tuple.ycoord;
-          it->zcoord = tuple.zcoord;
-          it->xvelocity = tuple.xvelocity;
-          it->yvelocity = tuple.yvelocity;
-          it->zvelocity = tuple.zvelocity;
-          it->recordedTime = tuple.recordedTime;
-          it->dataRecordedTime = tuple.dataRecordedTime;
-          it->expireTime = tuple.expireTime;
-          it->nodeReceivedFrom = tuple.nodeReceivedFrom;
-          it->isBeingUpdated = false;
-          return;
+          NS_LOG_DEBUG ("Velocity vector is changed. Need to send trigger update");
+          it->isChanged = true;
+          needTriggerUpdate = true;
         }
+      //we should not replace *it with tuple but rather replace the values as the tuple might as well
+      //have link information associated with it and if replaced, that info will be lost.
+      it->xcoord = tuple.xcoord;
+      it->ycoord = tuple.ycoord;
+      it->zcoord = tuple.zcoord;
+      it->xvelocity = tuple.xvelocity;
+      it->yvelocity = tuple.yvelocity;
+      it->zvelocity = tuple.zvelocity;
+      it->recordedTime = tuple.recordedTime;
+      it->dataRecordedTime = tuple.dataRecordedTime;
+      it->expireTime = tuple.expireTime;
+      it->nodeReceivedFrom = tuple.nodeReceivedFrom;
+      it->isBeingUpdated = false;
+      UpdateArrays (it - &m_geographicSet[0]);
+      UpdateGrid (it - &m_geographicSet[0]);
+      return;
     }
   NS_LOG_DEBUG ("Added tuple for " << tuple.nodeAddr);
+  m_geographicIndex[tuple.nodeAddr] = m_geographicSet.size ();
   m_geographicSet.push_back (tuple);
+  m_slotCell.push_back (NO_CELL);
+  if (m_arraysEnabled)
+    {
+      m_xcoords.push_back (0);
+      m_ycoords.push_back (0);
+      m_xvelocities.push_back (0);
+      m_yvelocities.push_back (0);
+    }
+  UpdateArrays (m_geographicSet.size () - 1);
+  UpdateGrid (m_geographicSet.size () - 1);
   // if we come here then there is no tuple present in the table.
   // thus set isChanged to true irrespective of what it is.
-  UpdateTupleIsChanged (tuple.nodeAddr, true);
+  m_geographicSet.back ().isChanged = true;
 }
 
 
 void
 SiftGeo::EraseGeographicTuple (const GeographicTuple &tuple)
 {
-  NS_LOG_FUNCTION(this << tuple);
-  Time now = Simulator::Now ();
-  for (GeographicSet::iterator it = m_geographicSet.begin ();
-       it != m_geographicSet.end (); it++)
+  NS_LOG_FUNCTION (this << tuple);
+  GeographicTuple *it = FindGeographicTuple (tuple.nodeAddr);
+  if (it != NULL)
     {
-      if (it->nodeAddr == tuple.nodeAddr)
-        {
-          /*
-           * Instead of erasing the tuple, I am inserting default values so that we do not loose the link information.
-           */
-          //m_geographicSet.erase (it);
-          it->xcoord = 9999;
-          it->ycoord = 9999;
-          it->zcoord = 9999;
-          it->xvelocity = 256;
-          it->yvelocity = 256;
-          it->zvelocity = 256;
-          it->recordedTime = now;
-          it->startTime = Seconds (0);
-          it->expireTime = Seconds (0);
-          it->dataRecordedTime = Seconds (0);
-          it->isBeingUpdated = false;
-          it->isChanged = false;
-          it->nodeReceivedFrom = Ipv4Address ();
-          break;
-        }
+      /*
+       * Instead of erasing the tuple, I am inserting default values so that we do not loose the link information.
+       * This also keeps the positions held by the index valid.
+       */
+      it->xcoord = 9999;
+      it->ycoord = 9999;
+      it->zcoord = 9999;
+      it->xvelocity = 256;
+      it->yvelocity = 256;
+      it->zvelocity = 256;
+      it->recordedTime = Simulator::Now ();
+      it->startTime = Seconds (0);
+      it->expireTime = Seconds (0);
+      it->dataRecordedTime = Seconds (0);
+      it->isBeingUpdated = false;
+      it->isChanged = false;
+      it->nodeReceivedFrom = Ipv4Address ();
+      UpdateArrays (it - &m_geographicSet[0]);
+      RemoveFromGrid (it - &m_geographicSet[0]);
     }
 }
 
@@ -140,8 +152,8 @@ SiftGeo::EraseGeographicTuple (const GeographicTuple &tuple)
 void
 SiftGeo::UpdateAllTupleIsChanged (bool isChanged)
 {
-   NS_LOG_FUNCTION(this);
-   for (GeographicSet::iterator it = m_geographicSet.begin (); it != m_geographicSet.end (); it++)
+  NS_LOG_FUNCTION (this);
+  for (GeographicSet::iterator it = m_geographicSet.begin (); it != m_geographicSet.end (); it++)
     {
       it->isChanged = isChanged;
     }
@@ -150,43 +162,285 @@ SiftGeo::UpdateAllTupleIsChanged (bool isChanged)
 void
 SiftGeo::UpdateTupleIsChanged (const Ipv4Address nodeAddress, bool isChanged)
 {
-   NS_LOG_FUNCTION(this << nodeAddress);
-   for (GeographicSet::iterator it = m_geographicSet.begin (); it != m_geographicSet.end (); it++)
+  NS_LOG_FUNCTION (this << nodeAddress);
+  GeographicTuple *it = FindGeographicTuple (nodeAddress);
+  if (it != NULL)
     {
-      if (it->nodeAddr == nodeAddress)
-        {
-          it->isChanged = isChanged;
-        }
+      it->isChanged = isChanged;
     }
 }
 
 void
 SiftGeo::SetIsBeingUpdated (const Ipv4Address nodeAddress, bool isBeingUpdated)
 {
-	NS_LOG_FUNCTION(this << nodeAddress);
-	for (GeographicSet::iterator it = m_geographicSet.begin (); it != m_geographicSet.end (); it++)
+  NS_LOG_FUNCTION (this << nodeAddress);
+  GeographicTuple *it = FindGeographicTuple (nodeAddress);
+  if (it != NULL)
+    {
+      it->isBeingUpdated = isBeingUpdated;
+    }
+}
+
+bool
+SiftGeo::GetIsBeingUpdated (const Ipv4Address nodeAddress)
+{
+  NS_LOG_FUNCTION (this << nodeAddress);
+  GeographicTuple *it = FindGeographicTuple (nodeAddress);
+  if (it != NULL)
+    {
+      return it->isBeingUpdated;
+    }
+  return false;
+}
+
+
+bool
+SiftGeo::PredictPosition (const Ipv4Address &nodeAddress, Time now, Time maxStaleness,
+                          double &x, double &y) const
+{
+  NS_LOG_FUNCTION (this << nodeAddress << now << maxStaleness);
+  GeographicIndex::const_iterator it = m_geographicIndex.find (nodeAddress);
+  if (it == m_geographicIndex.end ())
+    {
+      return false;
+    }
+  const GeographicTuple &tuple = m_geographicSet[it->second];
+  // An erased tuple expires at time zero
+  if (tuple.expireTime < now)
+    {
+      return false;
+    }
+  Time age = now - tuple.recordedTime;
+  if (age > maxStaleness)
+    {
+      return false;
+    }
+  double elapsed = std::max (0.0, age.GetSeconds ());
+  // Coordinates are stored unsigned but hold signed positions
+  x = static_cast<int32_t> (tuple.xcoord) + tuple.xvelocity * elapsed;
+  y = static_cast<int32_t> (tuple.ycoord) + tuple.yvelocity * elapsed;
+  NS_LOG_DEBUG ("Predicted position of " << nodeAddress << " after " << elapsed << "s: " << x << ", " << y);
+  return true;
+}
+
+void
+SiftGeo::SetGridCellSize (double cellSize)
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT_MSG (cellSize > 0, "The grid cell size must be positive");
+  m_cellSize = cellSize;
+  m_grid.clear ();
+  for (uint32_t slot = 0; slot < m_geographicSet.size (); ++slot)
     {
-      if (it->nodeAddr == nodeAddress)
+      bool inGrid = (m_slotCell[slot] != NO_CELL);
+      m_slotCell[slot] = NO_CELL;
+      if (inGrid)
         {
-          it->isBeingUpdated = isBeingUpdated;
+          UpdateGrid (slot);
         }
     }
 }
 
+double
+SiftGeo::GetGridCellSize () const
+{
+  return m_cellSize;
+}
+
+void
+SiftGeo::SetArraysEnabled (bool enabled)
+{
+  NS_LOG_FUNCTION (this << enabled);
+  m_arraysEnabled = enabled;
+  uint32_t size = enabled ? m_geographicSet.size () : 0;
+  m_xcoords.assign (size, 0);
+  m_ycoords.assign (size, 0);
+  m_xvelocities.assign (size, 0);
+  m_yvelocities.assign (size, 0);
+  for (uint32_t slot = 0; slot < size; ++slot)
+    {
+      UpdateArrays (slot);
+    }
+}
+
 bool
-SiftGeo::GetIsBeingUpdated (const Ipv4Address nodeAddress)
+SiftGeo::GetArraysEnabled () const
 {
-	NS_LOG_FUNCTION(this << nodeAddress);
-	for (GeographicSet::iterator it = m_geographicSet.begin (); it != m_geographicSet.end (); it++)
+  return m_arraysEnabled;
+}
+
+void
+SiftGeo::UpdateArrays (uint32_t slot)
+{
+  if (!m_arraysEnabled)
     {
-      if (it->nodeAddr == nodeAddress)
+      return;
+    }
+  const GeographicTuple &tuple = m_geographicSet[slot];
+  // Coordinates are stored unsigned but hold signed positions
+  m_xcoords[slot] = static_cast<int32_t> (tuple.xcoord);
+  m_ycoords[slot] = static_cast<int32_t> (tuple.ycoord);
+  m_xvelocities[slot] = tuple.xvelocity;
+  m_yvelocities[slot] = tuple.yvelocity;
+}
+
+void
+SiftGeo::GetDistancesToPoint (double x, double y, std::vector<double> &distances) const
+{
+  NS_LOG_FUNCTION (this << x << y);
+  NS_ASSERT_MSG (m_arraysEnabled, "The coordinate arrays of the geographic set are not enabled");
+  distances.resize (m_xcoords.size ());
+  if (!distances.empty ())
+    {
+      BatchDistanceToPoint (&m_xcoords[0], &m_ycoords[0], m_xcoords.size (), x, y, &distances[0]);
+    }
+}
+
+void
+SiftGeo::GetDistancesToTrajectory (double x1, double y1, double x2, double y2,
+                                   std::vector<double> &distances) const
+{
+  NS_LOG_FUNCTION (this << x1 << y1 << x2 << y2);
+  NS_ASSERT_MSG (m_arraysEnabled, "The coordinate arrays of the geographic set are not enabled");
+  distances.resize (m_xcoords.size ());
+  if (!distances.empty ())
+    {
+      BatchDistanceToSegment (&m_xcoords[0], &m_ycoords[0], m_xcoords.size (),
+                              x1, y1, x2, y2, &distances[0]);
+    }
+}
+
+uint64_t
+SiftGeo::MakeCellKey (int32_t cx, int32_t cy)
+{
+  return (static_cast<uint64_t> (static_cast<uint32_t> (cx)) << 32) | static_cast<uint32_t> (cy);
+}
+
+uint64_t
+SiftGeo::GetCellKey (double x, double y) const
+{
+  return MakeCellKey (static_cast<int32_t> (std::floor (x / m_cellSize)),
+                      static_cast<int32_t> (std::floor (y / m_cellSize)));
+}
+
+void
+SiftGeo::UpdateGrid (uint32_t slot)
+{
+  const GeographicTuple &tuple = m_geographicSet[slot];
+  // Coordinates are stored unsigned but hold signed positions
+  uint64_t cell = GetCellKey (static_cast<int32_t> (tuple.xcoord), static_cast<int32_t> (tuple.ycoord));
+  if (cell == m_slotCell[slot])
+    {
+      return;
+    }
+  RemoveFromGrid (slot);
+  m_grid[cell].push_back (slot);
+  m_slotCell[slot] = cell;
+}
+
+void
+SiftGeo::RemoveFromGrid (uint32_t slot)
+{
+  if (m_slotCell[slot] == NO_CELL)
+    {
+      return;
+    }
+  GeographicGrid::iterator cell = m_grid.find (m_slotCell[slot]);
+  NS_ASSERT (cell != m_grid.end ());
+  std::vector<uint32_t> &slots = cell->second;
+  std::vector<uint32_t>::iterator it = std::find (slots.begin (), slots.end (), slot);
+  NS_ASSERT (it != slots.end ());
+  *it = slots.back ();
+  slots.pop_back ();
+  if (slots.empty ())
+    {
+      m_grid.erase (cell);
+    }
+  m_slotCell[slot] = NO_CELL;
+}
+
+void
+SiftGeo::CollectCell (uint64_t cell, double x1, double y1, double x2, double y2, double width,
+                      std::vector<Ipv4Address> &nodes) const
+{
+  GeographicGrid::const_iterator it = m_grid.find (cell);
+  if (it == m_grid.end ())
+    {
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator slot = it->second.begin (); slot != it->second.end (); ++slot)
+    {
+      const GeographicTuple &tuple = m_geographicSet[*slot];
+      double x = static_cast<int32_t> (tuple.xcoord);
+      double y = static_cast<int32_t> (tuple.ycoord);
+      if (DistanceToSegment (x, y, x1, y1, x2, y2) <= width)
         {
-          return it->isBeingUpdated;
+          nodes.push_back (tuple.nodeAddr);
+        }
+    }
+}
+
+void
+SiftGeo::GetNodesInRadius (double x, double y, double radius, std::vector<Ipv4Address> &nodes) const
+{
+  NS_LOG_FUNCTION (this << x << y << radius);
+  nodes.clear ();
+  int32_t cxMin = static_cast<int32_t> (std::floor ((x - radius) / m_cellSize));
+  int32_t cxMax = static_cast<int32_t> (std::floor ((x + radius) / m_cellSize));
+  int32_t cyMin = static_cast<int32_t> (std::floor ((y - radius) / m_cellSize));
+  int32_t cyMax = static_cast<int32_t> (std::floor ((y + radius) / m_cellSize));
+  for (int32_t cx = cxMin; cx <= cxMax; ++cx)
+    {
+      for (int32_t cy = cyMin; cy <= cyMax; ++cy)
+        {
+          CollectCell (MakeCellKey (cx, cy), x, y, x, y, radius, nodes);
         }
     }
-  return false;
 }
 
+void
+SiftGeo::GetNodesNearSegment (double x1, double y1, double x2, double y2, double width,
+                              std::vector<Ipv4Address> &nodes) const
+{
+  NS_LOG_FUNCTION (this << x1 << y1 << x2 << y2 << width);
+  nodes.clear ();
+  double dx = x2 - x1;
+  double dy = y2 - y1;
+  double length = std::sqrt (dx * dx + dy * dy);
+  if (length == 0)
+    {
+      GetNodesInRadius (x1, y1, width, nodes);
+      return;
+    }
+  // Walk the cells along the major axis of the segment. In each column (or row) only the
+  // cells the corridor crosses are visited, so the cost follows the corridor area rather
+  // than the bounding box of the segment.
+  bool alongX = std::fabs (dx) >= std::fabs (dy);
+  double u1 = alongX ? x1 : y1;
+  double v1 = alongX ? y1 : x1;
+  double du = alongX ? dx : dy;
+  double dv = alongX ? dy : dx;
+  double uMin = std::min (u1, u1 + du);
+  double uMax = std::max (u1, u1 + du);
+  // Extent of the corridor across the major axis
+  double spread = width * length / std::fabs (du);
+  int32_t cuMin = static_cast<int32_t> (std::floor ((uMin - width) / m_cellSize));
+  int32_t cuMax = static_cast<int32_t> (std::floor ((uMax + width) / m_cellSize));
+  for (int32_t cu = cuMin; cu <= cuMax; ++cu)
+    {
+      double uA = std::max (uMin, std::min (uMax, cu * m_cellSize));
+      double uB = std::max (uMin, std::min (uMax, (cu + 1) * m_cellSize));
+      double vA = v1 + (uA - u1) * dv / du;
+      double vB = v1 + (uB - u1) * dv / du;
+      int32_t cvMin = static_cast<int32_t> (std::floor ((std::min (vA, vB) - spread) / m_cellSize));
+      int32_t cvMax = static_cast<int32_t> (std::floor ((std::max (vA, vB) + spread) / m_cellSize));
+      for (int32_t cv = cvMin; cv <= cvMax; ++cv)
+        {
+          uint64_t cell = alongX ? MakeCellKey (cu, cv) : MakeCellKey (cv, cu);
+          CollectCell (cell, x1, y1, x2, y2, width, nodes);
+        }
+    }
+}
 
 } // namespace sift
 } // namespace ns3
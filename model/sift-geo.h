@@ -28,8 +28,10 @@
 #define __SIFT_GEO_H__
 
 #include "ns3/timer.h"
+#include "ns3/ipv4-address.h"
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include "sift-repository.h"
 
@@ -49,6 +51,25 @@ class SiftGeo
 
 protected:
   GeographicSet m_geographicSet;
+  /// node address -> position of its tuple in m_geographicSet. Tuples are never
+  /// removed from the set, so a position stays valid and the set keeps insertion order.
+  typedef std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> GeographicIndex;
+  GeographicIndex m_geographicIndex;
+  /// Uniform grid over the coordinates of the tuples: cell key -> slots in that cell
+  typedef std::unordered_map<uint64_t, std::vector<uint32_t> > GeographicGrid;
+  GeographicGrid m_grid;
+  /// cell key of each slot, NO_CELL if the slot is not in the grid
+  std::vector<uint64_t> m_slotCell;
+  /// side of a grid cell in meters
+  double m_cellSize;
+  /// Position and velocity of each slot kept in separate arrays (structure of arrays),
+  /// so scans over all nodes read only the values they need and can be vectorized.
+  /// Only kept when enabled, empty otherwise
+  bool m_arraysEnabled;
+  std::vector<double> m_xcoords;
+  std::vector<double> m_ycoords;
+  std::vector<double> m_xvelocities;
+  std::vector<double> m_yvelocities;
   //GeographicSet m_tempGeographicSet;
 
 
@@ -88,8 +109,8 @@ public:
   void UpdateTupleIsChanged (const Ipv4Address nodeAddress, bool isChanged);
   //void CopyToTempGeographicTuple (void);
 
-  //set to store the current topology information
-  GeographicSet & GetGeographicInfo ()
+  //set to store the current topology information, in insertion order
+  const GeographicSet & GetGeographicInfo () const
   {
     return m_geographicSet;
   }
@@ -102,6 +123,93 @@ public:
 
   bool RemoveNodeFromTempSet (Ipv4Address node1Address);
 
+  /** param cellSize side of a grid cell in meters, usually the radio range
+   *  set the cell size of the spatial index and rebuild it
+   */
+  void SetGridCellSize (double cellSize);
+  /**
+   * get the cell size of the spatial index
+   */
+  double GetGridCellSize () const;
+  /** param nodeAddress Ip address of the node
+   *  param now the time the position is wanted for
+   *  param maxStaleness how old the record of the node may be
+   *  param x, y set to the position of the node at now, extrapolated from its last recorded
+   *  position and velocity
+   *  returns false if the node is unknown, erased or its record is older than maxStaleness
+   */
+  bool PredictPosition (const Ipv4Address &nodeAddress, Time now, Time maxStaleness,
+                        double &x, double &y) const;
+
+  /** param x, y the center of the query
+   *  param radius the radius of the query
+   *  param nodes filled with the address of every node within radius of (x, y)
+   */
+  void GetNodesInRadius (double x, double y, double radius, std::vector<Ipv4Address> &nodes) const;
+  /** param x1, y1, x2, y2 the end points of a segment, such as the source -> destination trajectory
+   *  param width the half width of the corridor
+   *  param nodes filled with the address of every node within width of the segment
+   */
+  void GetNodesNearSegment (double x1, double y1, double x2, double y2, double width,
+                            std::vector<Ipv4Address> &nodes) const;
+
+  /** param enabled whether the coordinate arrays are kept
+   *  the arrays are only read by GetDistancesToPoint and GetDistancesToTrajectory, so they are
+   *  not kept by default. Enabling them fills them from the current tuples.
+   */
+  void SetArraysEnabled (bool enabled);
+  /**
+   * whether the coordinate arrays are kept
+   */
+  bool GetArraysEnabled () const;
+  /// x coordinate of each slot, in the order of GetGeographicInfo (), empty unless the arrays are enabled
+  const std::vector<double> & GetXCoords () const
+  {
+    return m_xcoords;
+  }
+  /// y coordinate of each slot, in the order of GetGeographicInfo ()
+  const std::vector<double> & GetYCoords () const
+  {
+    return m_ycoords;
+  }
+  /// x velocity of each slot, in the order of GetGeographicInfo ()
+  const std::vector<double> & GetXVelocities () const
+  {
+    return m_xvelocities;
+  }
+  /// y velocity of each slot, in the order of GetGeographicInfo ()
+  const std::vector<double> & GetYVelocities () const
+  {
+    return m_yvelocities;
+  }
+  /** param x, y the reference point
+   *  param distances filled with the distance of every slot from (x, y), in the order of
+   *  GetGeographicInfo (). Erased tuples keep their placeholder coordinates.
+   */
+  void GetDistancesToPoint (double x, double y, std::vector<double> &distances) const;
+  /** param x1, y1, x2, y2 ends of the segment of the trajectory
+   *  param distances filled with the distance of every slot from the segment, in the
+   *  order of GetGeographicInfo (). Nodes beyond an end are measured from it, as for the
+   *  corridor in SiftRouting::Receive.
+   */
+  void GetDistancesToTrajectory (double x1, double y1, double x2, double y2,
+                                 std::vector<double> &distances) const;
+
+private:
+  /// Copy the position and velocity of a slot into the coordinate arrays
+  void UpdateArrays (uint32_t slot);
+  /// Key of the grid cell holding (x, y)
+  uint64_t GetCellKey (double x, double y) const;
+  /// Key of the grid cell at column cx and row cy
+  static uint64_t MakeCellKey (int32_t cx, int32_t cy);
+  /// Move a slot to the cell matching its coordinates
+  void UpdateGrid (uint32_t slot);
+  /// Take a slot out of the grid
+  void RemoveFromGrid (uint32_t slot);
+  /// Append the slots of one cell whose tuple is within width of the segment
+  void CollectCell (uint64_t cell, double x1, double y1, double x2, double y2, double width,
+                    std::vector<Ipv4Address> &nodes) const;
+
 };
 
 } // namespace sift
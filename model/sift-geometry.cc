@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ */
+
+#include "sift-geometry.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#if defined (__AVX__)
+#include <immintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ns3 {
+namespace sift {
+
+void
+BatchDistanceToPoint (const double *x, const double *y, uint32_t n,
+                      double px, double py, double *out)
+{
+  uint32_t i = 0;
+#if defined (__AVX__)
+  __m256d vpx = _mm256_set1_pd (px);
+  __m256d vpy = _mm256_set1_pd (py);
+  for (; i + 4 <= n; i += 4)
+    {
+      __m256d dx = _mm256_sub_pd (_mm256_loadu_pd (x + i), vpx);
+      __m256d dy = _mm256_sub_pd (_mm256_loadu_pd (y + i), vpy);
+      __m256d d2 = _mm256_add_pd (_mm256_mul_pd (dx, dx), _mm256_mul_pd (dy, dy));
+      _mm256_storeu_pd (out + i, _mm256_sqrt_pd (d2));
+    }
+#elif defined (__SSE2__)
+  __m128d vpx = _mm_set1_pd (px);
+  __m128d vpy = _mm_set1_pd (py);
+  for (; i + 2 <= n; i += 2)
+    {
+      __m128d dx = _mm_sub_pd (_mm_loadu_pd (x + i), vpx);
+      __m128d dy = _mm_sub_pd (_mm_loadu_pd (y + i), vpy);
+      __m128d d2 = _mm_add_pd (_mm_mul_pd (dx, dx), _mm_mul_pd (dy, dy));
+      _mm_storeu_pd (out + i, _mm_sqrt_pd (d2));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      double dx = x[i] - px;
+      double dy = y[i] - py;
+      out[i] = std::sqrt (dx * dx + dy * dy);
+    }
+}
+
+double
+DistanceToPoint (int32_t px, int32_t py, int32_t x, int32_t y)
+{
+  int64_t dx = static_cast<int64_t> (px) - x;
+  int64_t dy = static_cast<int64_t> (py) - y;
+  return std::sqrt (static_cast<double> (dx * dx + dy * dy));
+}
+
+namespace {
+
+template <typename T>
+T
+ClampUnit (T t)
+{
+  return std::min (T (1), std::max (T (0), t));
+}
+
+template <typename T>
+T
+ProgressOnSegment (T px, T py, T x1, T y1, T x2, T y2)
+{
+  T dx = x2 - x1;
+  T dy = y2 - y1;
+  T length2 = dx * dx + dy * dy;
+  return length2 > 0 ? ((px - x1) * dx + (py - y1) * dy) / length2 : T (1);
+}
+
+template <typename T>
+T
+DistanceToClampedProjection (T px, T py, T x1, T y1, T x2, T y2)
+{
+  T dx = x2 - x1;
+  T dy = y2 - y1;
+  T length2 = dx * dx + dy * dy;
+  // Without length the dot product is 0, and so is the projection
+  T t = ClampUnit (((px - x1) * dx + (py - y1) * dy) / std::max (length2, std::numeric_limits<T>::min ()));
+  T ex = x1 + t * dx - px;
+  T ey = y1 + t * dy - py;
+  return std::sqrt (ex * ex + ey * ey);
+}
+
+} // anonymous namespace
+
+double
+SegmentProgress (double px, double py, double x1, double y1, double x2, double y2)
+{
+  return ProgressOnSegment (px, py, x1, y1, x2, y2);
+}
+
+float
+SegmentProgress (float px, float py, float x1, float y1, float x2, float y2)
+{
+  return ProgressOnSegment (px, py, x1, y1, x2, y2);
+}
+
+double
+SegmentProgress (int32_t px, int32_t py, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+  int64_t dx = static_cast<int64_t> (x2) - x1;
+  int64_t dy = static_cast<int64_t> (y2) - y1;
+  int64_t length2 = dx * dx + dy * dy;
+  if (length2 == 0)
+    {
+      return 1;
+    }
+  int64_t dot = (static_cast<int64_t> (px) - x1) * dx + (static_cast<int64_t> (py) - y1) * dy;
+  return static_cast<double> (dot) / static_cast<double> (length2);
+}
+
+double
+DistanceToSegment (double px, double py, double x1, double y1, double x2, double y2)
+{
+  return DistanceToClampedProjection (px, py, x1, y1, x2, y2);
+}
+
+float
+DistanceToSegment (float px, float py, float x1, float y1, float x2, float y2)
+{
+  return DistanceToClampedProjection (px, py, x1, y1, x2, y2);
+}
+
+double
+DistanceToSegment (int32_t px, int32_t py, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+  int64_t dx = static_cast<int64_t> (x2) - x1;
+  int64_t dy = static_cast<int64_t> (y2) - y1;
+  int64_t ax = static_cast<int64_t> (px) - x1;
+  int64_t ay = static_cast<int64_t> (py) - y1;
+  int64_t dot = ax * dx + ay * dy;
+  // The branches skip the division and the second square root at the ends; selecting among
+  // the three distances without them was not faster
+  if (dot <= 0)
+    {
+      // Behind the start, or the segment has no length
+      return std::sqrt (static_cast<double> (ax * ax + ay * ay));
+    }
+  int64_t length2 = dx * dx + dy * dy;
+  if (dot >= length2)
+    {
+      int64_t bx = static_cast<int64_t> (px) - x2;
+      int64_t by = static_cast<int64_t> (py) - y2;
+      return std::sqrt (static_cast<double> (bx * bx + by * by));
+    }
+  int64_t cross = ax * dy - ay * dx;
+  return std::fabs (static_cast<double> (cross)) / std::sqrt (static_cast<double> (length2));
+}
+
+void
+BatchDistanceToSegment (const double *x, const double *y, uint32_t n,
+                        double x1, double y1, double x2, double y2, double *out)
+{
+  double dx = x2 - x1;
+  double dy = y2 - y1;
+  double length2 = dx * dx + dy * dy;
+  // With no length every projection falls on the start, which is also the end
+  double scale = length2 > 0 ? 1 / length2 : 0;
+  uint32_t i = 0;
+#if defined (__AVX__)
+  __m256d vx1 = _mm256_set1_pd (x1);
+  __m256d vy1 = _mm256_set1_pd (y1);
+  __m256d vdx = _mm256_set1_pd (dx);
+  __m256d vdy = _mm256_set1_pd (dy);
+  __m256d vscale = _mm256_set1_pd (scale);
+  __m256d zero = _mm256_setzero_pd ();
+  __m256d one = _mm256_set1_pd (1);
+  for (; i + 4 <= n; i += 4)
+    {
+      __m256d ax = _mm256_sub_pd (_mm256_loadu_pd (x + i), vx1);
+      __m256d ay = _mm256_sub_pd (_mm256_loadu_pd (y + i), vy1);
+      __m256d t = _mm256_mul_pd (_mm256_add_pd (_mm256_mul_pd (ax, vdx), _mm256_mul_pd (ay, vdy)), vscale);
+      t = _mm256_min_pd (one, _mm256_max_pd (zero, t));
+      __m256d ex = _mm256_sub_pd (_mm256_mul_pd (t, vdx), ax);
+      __m256d ey = _mm256_sub_pd (_mm256_mul_pd (t, vdy), ay);
+      __m256d d2 = _mm256_add_pd (_mm256_mul_pd (ex, ex), _mm256_mul_pd (ey, ey));
+      _mm256_storeu_pd (out + i, _mm256_sqrt_pd (d2));
+    }
+#elif defined (__SSE2__)
+  __m128d vx1 = _mm_set1_pd (x1);
+  __m128d vy1 = _mm_set1_pd (y1);
+  __m128d vdx = _mm_set1_pd (dx);
+  __m128d vdy = _mm_set1_pd (dy);
+  __m128d vscale = _mm_set1_pd (scale);
+  __m128d zero = _mm_setzero_pd ();
+  __m128d one = _mm_set1_pd (1);
+  for (; i + 2 <= n; i += 2)
+    {
+      __m128d ax = _mm_sub_pd (_mm_loadu_pd (x + i), vx1);
+      __m128d ay = _mm_sub_pd (_mm_loadu_pd (y + i), vy1);
+      __m128d t = _mm_mul_pd (_mm_add_pd (_mm_mul_pd (ax, vdx), _mm_mul_pd (ay, vdy)), vscale);
+      t = _mm_min_pd (one, _mm_max_pd (zero, t));
+      __m128d ex = _mm_sub_pd (_mm_mul_pd (t, vdx), ax);
+      __m128d ey = _mm_sub_pd (_mm_mul_pd (t, vdy), ay);
+      __m128d d2 = _mm_add_pd (_mm_mul_pd (ex, ex), _mm_mul_pd (ey, ey));
+      _mm_storeu_pd (out + i, _mm_sqrt_pd (d2));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      double ax = x[i] - x1;
+      double ay = y[i] - y1;
+      double t = std::min (1.0, std::max (0.0, (ax * dx + ay * dy) * scale));
+      double ex = t * dx - ax;
+      double ey = t * dy - ay;
+      out[i] = std::sqrt (ex * ex + ey * ey);
+    }
+}
+
+void
+BatchSegmentProgress (const double *x, const double *y, uint32_t n,
+                      double x1, double y1, double x2, double y2, double *out)
+{
+  double dx = x2 - x1;
+  double dy = y2 - y1;
+  double length2 = dx * dx + dy * dy;
+  if (length2 == 0)
+    {
+      std::fill (out, out + n, 1.0);
+      return;
+    }
+  double ux = dx / length2;
+  double uy = dy / length2;
+  uint32_t i = 0;
+#if defined (__AVX__)
+  __m256d vx1 = _mm256_set1_pd (x1);
+  __m256d vy1 = _mm256_set1_pd (y1);
+  __m256d vdx = _mm256_set1_pd (ux);
+  __m256d vdy = _mm256_set1_pd (uy);
+  for (; i + 4 <= n; i += 4)
+    {
+      __m256d ax = _mm256_sub_pd (_mm256_loadu_pd (x + i), vx1);
+      __m256d ay = _mm256_sub_pd (_mm256_loadu_pd (y + i), vy1);
+      _mm256_storeu_pd (out + i, _mm256_add_pd (_mm256_mul_pd (ax, vdx), _mm256_mul_pd (ay, vdy)));
+    }
+#elif defined (__SSE2__)
+  __m128d vx1 = _mm_set1_pd (x1);
+  __m128d vy1 = _mm_set1_pd (y1);
+  __m128d vdx = _mm_set1_pd (ux);
+  __m128d vdy = _mm_set1_pd (uy);
+  for (; i + 2 <= n; i += 2)
+    {
+      __m128d ax = _mm_sub_pd (_mm_loadu_pd (x + i), vx1);
+      __m128d ay = _mm_sub_pd (_mm_loadu_pd (y + i), vy1);
+      _mm_storeu_pd (out + i, _mm_add_pd (_mm_mul_pd (ax, vdx), _mm_mul_pd (ay, vdy)));
+    }
+#endif
+  for (; i < n; ++i)
+    {
+      out[i] = (x[i] - x1) * ux + (y[i] - y1) * uy;
+    }
+}
+
+const char *
+GetGeometryKernelName (void)
+{
+#if defined (__AVX__)
+  return "avx";
+#elif defined (__SSE2__)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+} // namespace sift
+} // namespace ns3
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ */
+
+/// \brief	Geometry kernels used by SiFT: distances and progress along the trajectory,
+///		for one point or in batch over the position arrays of SiftGeo.
+
+#ifndef SIFT_GEOMETRY_H
+#define SIFT_GEOMETRY_H
+
+#include <stdint.h>
+
+namespace ns3 {
+namespace sift {
+
+/**
+ * \brief Distance of n points from one point.
+ *
+ * \param x x coordinates of the points
+ * \param y y coordinates of the points
+ * \param n number of points
+ * \param px x coordinate of the reference point
+ * \param py y coordinate of the reference point
+ * \param out filled with n distances, out[i] belongs to (x[i], y[i])
+ *
+ * Uses AVX or SSE2 when the module is compiled with them, a scalar loop otherwise.
+ */
+void BatchDistanceToPoint (const double *x, const double *y, uint32_t n,
+                           double px, double py, double *out);
+
+/**
+ * \brief Distance between two points with integer coordinates, such as those of SiftHeader.
+ *
+ * \param px x coordinate of the first point
+ * \param py y coordinate of the first point
+ * \param x x coordinate of the second point
+ * \param y y coordinate of the second point
+ * \returns the distance, from the square computed exactly in 64-bit integers
+ */
+double DistanceToPoint (int32_t px, int32_t py, int32_t x, int32_t y);
+
+/**
+ * \brief Position of the projection of a point on the segment from (x1, y1) to (x2, y2).
+ *
+ * \param px x coordinate of the point
+ * \param py y coordinate of the point
+ * \param x1 x coordinate of the start of the segment
+ * \param y1 y coordinate of the start of the segment
+ * \param x2 x coordinate of the end of the segment
+ * \param y2 y coordinate of the end of the segment
+ * \returns 0 at the start of the segment, 1 at its end, below 0 or above 1 beyond them.
+ * 1 if the segment has no length.
+ */
+double SegmentProgress (double px, double py, double x1, double y1, double x2, double y2);
+/**
+ * \brief SegmentProgress in single precision.
+ */
+float SegmentProgress (float px, float py, float x1, float y1, float x2, float y2);
+/**
+ * \brief SegmentProgress for integer coordinates, such as those of SiftHeader.
+ *
+ * The products are computed exactly in 64-bit integers and only their ratio is rounded.
+ * The coordinates must be within 2^30 of 0.
+ */
+double SegmentProgress (int32_t px, int32_t py, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+/**
+ * \brief Distance of a point from the segment from (x1, y1) to (x2, y2).
+ *
+ * \param px x coordinate of the point
+ * \param py y coordinate of the point
+ * \param x1 x coordinate of the start of the segment
+ * \param y1 y coordinate of the start of the segment
+ * \param x2 x coordinate of the end of the segment
+ * \param y2 y coordinate of the end of the segment
+ * \returns the distance from the nearest point of the segment, an end point beyond its ends
+ *
+ * The projection is clamped to the segment. A segment without length gives the distance
+ * from its end points.
+ */
+double DistanceToSegment (double px, double py, double x1, double y1, double x2, double y2);
+/**
+ * \brief DistanceToSegment in single precision.
+ */
+float DistanceToSegment (float px, float py, float x1, float y1, float x2, float y2);
+/**
+ * \brief DistanceToSegment for integer coordinates, such as those of SiftHeader.
+ *
+ * Whether the nearest point is an end point is decided exactly in 64-bit integers, so
+ * a point on the segment is at distance 0 and a point beyond an end is at the exact
+ * distance from it. The coordinates must be within 2^30 of 0.
+ */
+double DistanceToSegment (int32_t px, int32_t py, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+/**
+ * \brief Distance of n points from the segment from (x1, y1) to (x2, y2).
+ *
+ * \param x x coordinates of the points
+ * \param y y coordinates of the points
+ * \param n number of points
+ * \param x1 x coordinate of the start of the segment
+ * \param y1 y coordinate of the start of the segment
+ * \param x2 x coordinate of the end of the segment
+ * \param y2 y coordinate of the end of the segment
+ * \param out filled with n distances, out[i] belongs to (x[i], y[i])
+ *
+ * Same as DistanceToSegment for each point, with AVX or SSE2 when available.
+ */
+void BatchDistanceToSegment (const double *x, const double *y, uint32_t n,
+                             double x1, double y1, double x2, double y2, double *out);
+
+/**
+ * \brief Position of the projection of n points on the segment from (x1, y1) to (x2, y2).
+ *
+ * \param x x coordinates of the points
+ * \param y y coordinates of the points
+ * \param n number of points
+ * \param x1 x coordinate of the start of the segment
+ * \param y1 y coordinate of the start of the segment
+ * \param x2 x coordinate of the end of the segment
+ * \param y2 y coordinate of the end of the segment
+ * \param out filled with n positions, out[i] belongs to (x[i], y[i])
+ *
+ * Same as SegmentProgress for each point, with AVX or SSE2 when available.
+ */
+void BatchSegmentProgress (const double *x, const double *y, uint32_t n,
+                           double x1, double y1, double x2, double y2, double *out);
+
+/**
+ * \brief Name of the instruction set the batch kernels were compiled for
+ * \returns "avx", "sse2" or "scalar"
+ */
+const char * GetGeometryKernelName (void);
+
+} // namespace sift
+} // namespace ns3
+
+#endif /* SIFT_GEOMETRY_H */
@@ -31,12 +31,20 @@
 
 #define TTL 64
 #define HEADER_SIZE 48
+#define COMPACT_HEADER_SIZE 26
+#define COMPACT_WIDE_HEADER_SIZE 38
+#define COMPACT_FORMAT 0x80
+#define COMPACT_FLAG_WIDE 0x01
+#define COMPACT_FLAG_WAYPOINTS 0x04
 
 #include "ns3/assert.h"
+#include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
 #include "sift-header.h"
 #include "ns3/address-utils.h"
+#include <limits>
+#include <algorithm>
 
 namespace ns3 {
 namespace sift {
@@ -45,6 +53,10 @@ NS_LOG_COMPONENT_DEFINE ("SiftHeader");
 
 NS_OBJECT_ENSURE_REGISTERED (SiftHeader);
 
+int32_t SiftHeader::s_compactOriginX = 0;
+int32_t SiftHeader::s_compactOriginY = 0;
+uint16_t SiftHeader::s_compactResolution = 1;
+
 TypeId SiftHeader::GetTypeId ()
 {
   static TypeId tid = TypeId ("ns3::sift::SiftHeader")
@@ -82,6 +94,8 @@ SiftHeader::SiftHeader ()
     m_destYLoc (0),
     m_headerSeqNo (0),
     m_headerTTL (TTL),
+    m_pad (0),
+    m_compact (false),
     m_sourceAddress ((Ipv4Address)"127.0.0.1"),
     m_destAddress ((Ipv4Address)"127.0.0.1")
     //m_ipv4Address (0)
@@ -240,6 +254,123 @@ void SiftHeader::UpdateHeaderTTL ()
 }
 
 
+void SiftHeader::SetCompact (bool compact)
+{
+  NS_ASSERT_MSG (!compact || m_nextHeader < COMPACT_FORMAT, "Next header does not fit the compact format");
+  m_compact = compact;
+}
+
+bool SiftHeader::IsCompact () const
+{
+  return m_compact;
+}
+
+void SiftHeader::SetCompactGrid (int32_t originX, int32_t originY, uint16_t resolution)
+{
+  NS_ASSERT (resolution > 0);
+  s_compactOriginX = originX;
+  s_compactOriginY = originY;
+  s_compactResolution = resolution;
+}
+
+/**
+ * \brief Grid offset of a coordinate.
+ * \param coord the coordinate
+ * \param origin the same coordinate of the origin of the grid
+ * \param resolution distance between two grid points
+ * \param offset set to the offset
+ * \return false if the coordinate is not on the grid or its offset does not fit 16 bits
+ */
+static bool
+ToGridOffset (int32_t coord, int32_t origin, uint16_t resolution, int16_t &offset)
+{
+  int64_t delta = static_cast<int64_t> (coord) - origin;
+  if (delta % resolution != 0)
+    {
+      return false;
+    }
+  delta /= resolution;
+  if (delta < std::numeric_limits<int16_t>::min () || delta > std::numeric_limits<int16_t>::max ())
+    {
+      return false;
+    }
+  offset = static_cast<int16_t> (delta);
+  return true;
+}
+
+static int32_t
+FromGridOffset (int16_t offset, int32_t origin, uint16_t resolution)
+{
+  return static_cast<int32_t> (origin + static_cast<int64_t> (offset) * resolution);
+}
+
+bool SiftHeader::FitsCompactGrid () const
+{
+  int16_t offset;
+  for (std::vector<SiftWaypoint>::const_iterator it = m_waypoints.begin (); it != m_waypoints.end (); ++it)
+    {
+      if (!ToGridOffset (it->x, s_compactOriginX, s_compactResolution, offset)
+          || !ToGridOffset (it->y, s_compactOriginY, s_compactResolution, offset))
+        {
+          return false;
+        }
+    }
+  return ToGridOffset (m_sourceXLoc, s_compactOriginX, s_compactResolution, offset)
+         && ToGridOffset (m_sourceYLoc, s_compactOriginY, s_compactResolution, offset)
+         && ToGridOffset (m_lastsourceXLoc, s_compactOriginX, s_compactResolution, offset)
+         && ToGridOffset (m_lastsourceYLoc, s_compactOriginY, s_compactResolution, offset)
+         && ToGridOffset (m_destXLoc, s_compactOriginX, s_compactResolution, offset)
+         && ToGridOffset (m_destYLoc, s_compactOriginY, s_compactResolution, offset);
+}
+
+void SiftHeader::SetWaypoints (const std::vector<SiftWaypoint> &waypoints)
+{
+  NS_ASSERT (waypoints.size () <= MAX_WAYPOINTS);
+  m_waypoints = waypoints;
+  m_optionLength = waypoints.size ();
+  m_segmentsLeft = waypoints.size () + 1;
+}
+
+const std::vector<SiftWaypoint> & SiftHeader::GetWaypoints () const
+{
+  return m_waypoints;
+}
+
+void SimplifyTrajectory (std::vector<SiftWaypoint> &points)
+{
+  if (points.size () < 3)
+    {
+      return;
+    }
+  std::vector<SiftWaypoint>::iterator kept = points.begin ();
+  for (std::vector<SiftWaypoint>::iterator point = points.begin () + 1; point + 1 != points.end (); ++point)
+    {
+      const SiftWaypoint &next = *(point + 1);
+      int64_t ax = static_cast<int64_t> (point->x) - kept->x;
+      int64_t ay = static_cast<int64_t> (point->y) - kept->y;
+      int64_t bx = static_cast<int64_t> (next.x) - point->x;
+      int64_t by = static_cast<int64_t> (next.y) - point->y;
+      // On the line and not turning back
+      if (ax * by - ay * bx != 0 || ax * bx + ay * by < 0)
+        {
+          *++kept = *point;
+        }
+    }
+  *++kept = points.back ();
+  points.erase (kept + 1, points.end ());
+}
+
+void SiftHeader::GetActiveSegment (int32_t &x1, int32_t &y1, int32_t &x2, int32_t &y2) const
+{
+  uint32_t n = m_waypoints.size ();
+  // Segment k goes from the source (k = 0) or waypoint k - 1 to waypoint k or the destination (k = n)
+  uint32_t k = m_segmentsLeft > n ? 0 : n + 1 - std::max<uint32_t> (m_segmentsLeft, 1);
+  x1 = k == 0 ? m_sourceXLoc : m_waypoints[k - 1].x;
+  y1 = k == 0 ? m_sourceYLoc : m_waypoints[k - 1].y;
+  x2 = k == n ? m_destXLoc : m_waypoints[k].x;
+  y2 = k == n ? m_destYLoc : m_waypoints[k].y;
+}
+
 void SiftHeader::SetNumberAddress (uint8_t n)
 {
   m_ipv4Address.clear ();
@@ -289,6 +420,14 @@ void SiftHeader::Print (std::ostream &os) const
     << " Dest YLoc= " << (uint32_t)GetDestYLoc ()
     << " Seq No= " << (uint32_t) GetHeaderSeqNo ()
     << " TTL= " << (uint32_t)GetHeaderTTL ();
+  for (std::vector<SiftWaypoint>::const_iterator it = m_waypoints.begin (); it != m_waypoints.end (); ++it)
+    {
+      os << " Waypoint= (" << it->x << ", " << it->y << ")";
+    }
+  if (!m_waypoints.empty ())
+    {
+      os << " SegmentsLeft= " << (uint32_t)GetSegmentsLeft ();
+    }
 
 
 
@@ -314,7 +453,16 @@ void SiftHeader::Print ()
 
 uint32_t SiftHeader::GetSerializedSize () const
 {
-  return HEADER_SIZE;
+  uint32_t waypoints = m_waypoints.size ();
+  if (m_compact)
+    {
+      if (FitsCompactGrid ())
+        {
+          return COMPACT_HEADER_SIZE + (waypoints ? 2 + 4 * waypoints : 0);
+        }
+      return COMPACT_WIDE_HEADER_SIZE + (waypoints ? 2 + 8 * waypoints : 0);
+    }
+  return HEADER_SIZE + 8 * waypoints;
 }
 
 void SiftHeader::Serialize (Buffer::Iterator start) const
@@ -322,8 +470,76 @@ void SiftHeader::Serialize (Buffer::Iterator start) const
 
   Buffer::Iterator i = start;
 
+  if (m_compact)
+    {
+      bool fits = FitsCompactGrid ();
+      uint8_t flags = 0;
+      if (!fits)
+        {
+          flags |= COMPACT_FLAG_WIDE;
+        }
+      if (!m_waypoints.empty ())
+        {
+          flags |= COMPACT_FLAG_WAYPOINTS;
+        }
+      i.WriteU8 (COMPACT_FORMAT | m_nextHeader);
+      i.WriteU8 (flags);
+      i.WriteU8 (m_messageType);
+      i.WriteU8 (m_headerTTL);
+      i.WriteU16 (m_headerSeqNo);
+      if (fits)
+        {
+          int16_t offset = 0;
+          ToGridOffset (m_sourceXLoc, s_compactOriginX, s_compactResolution, offset);
+          i.WriteU16 (offset);
+          ToGridOffset (m_sourceYLoc, s_compactOriginY, s_compactResolution, offset);
+          i.WriteU16 (offset);
+          ToGridOffset (m_lastsourceXLoc, s_compactOriginX, s_compactResolution, offset);
+          i.WriteU16 (offset);
+          ToGridOffset (m_lastsourceYLoc, s_compactOriginY, s_compactResolution, offset);
+          i.WriteU16 (offset);
+          ToGridOffset (m_destXLoc, s_compactOriginX, s_compactResolution, offset);
+          i.WriteU16 (offset);
+          ToGridOffset (m_destYLoc, s_compactOriginY, s_compactResolution, offset);
+          i.WriteU16 (offset);
+        }
+      else
+        {
+          i.WriteU32 (m_sourceXLoc);
+          i.WriteU32 (m_sourceYLoc);
+          i.WriteU32 (m_lastsourceXLoc);
+          i.WriteU32 (m_lastsourceYLoc);
+          i.WriteU32 (m_destXLoc);
+          i.WriteU32 (m_destYLoc);
+        }
+      WriteTo (i, m_sourceAddress);
+      WriteTo (i, m_destAddress);
+      if (!m_waypoints.empty ())
+        {
+          i.WriteU8 (m_waypoints.size ());
+          i.WriteU8 (m_segmentsLeft);
+          for (std::vector<SiftWaypoint>::const_iterator it = m_waypoints.begin (); it != m_waypoints.end (); ++it)
+            {
+              if (fits)
+                {
+                  int16_t offset = 0;
+                  ToGridOffset (it->x, s_compactOriginX, s_compactResolution, offset);
+                  i.WriteU16 (offset);
+                  ToGridOffset (it->y, s_compactOriginY, s_compactResolution, offset);
+                  i.WriteU16 (offset);
+                }
+              else
+                {
+                  i.WriteU32 (it->x);
+                  i.WriteU32 (it->y);
+                }
+            }
+        }
+      return;
+    }
+
   i.WriteU8 (m_nextHeader);
-  i.WriteU8 (m_optionLength);
+  i.WriteU8 (m_waypoints.size ());
   i.WriteU8 (m_messageType);
   i.WriteU8 (m_segmentsLeft);
   i.WriteU32 (m_sourceId);
@@ -339,13 +555,74 @@ void SiftHeader::Serialize (Buffer::Iterator start) const
   i.WriteU8  (m_pad);
   WriteTo (i, m_sourceAddress);
   WriteTo (i, m_destAddress);
+  for (std::vector<SiftWaypoint>::const_iterator it = m_waypoints.begin (); it != m_waypoints.end (); ++it)
+    {
+      i.WriteU32 (it->x);
+      i.WriteU32 (it->y);
+    }
 }
 
 uint32_t SiftHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
 
+  m_waypoints.clear ();
   m_nextHeader = i.ReadU8 ();
+  m_compact = (m_nextHeader & COMPACT_FORMAT) != 0;
+  if (m_compact)
+    {
+      m_nextHeader &= ~COMPACT_FORMAT;
+      uint8_t flags = i.ReadU8 ();
+      m_messageType = i.ReadU8 ();
+      m_headerTTL = i.ReadU8 ();
+      m_headerSeqNo = i.ReadU16 ();
+      bool wide = flags & COMPACT_FLAG_WIDE;
+      if (wide)
+        {
+          m_sourceXLoc = i.ReadU32 ();
+          m_sourceYLoc = i.ReadU32 ();
+          m_lastsourceXLoc = i.ReadU32 ();
+          m_lastsourceYLoc = i.ReadU32 ();
+          m_destXLoc = i.ReadU32 ();
+          m_destYLoc = i.ReadU32 ();
+        }
+      else
+        {
+          m_sourceXLoc = FromGridOffset (i.ReadU16 (), s_compactOriginX, s_compactResolution);
+          m_sourceYLoc = FromGridOffset (i.ReadU16 (), s_compactOriginY, s_compactResolution);
+          m_lastsourceXLoc = FromGridOffset (i.ReadU16 (), s_compactOriginX, s_compactResolution);
+          m_lastsourceYLoc = FromGridOffset (i.ReadU16 (), s_compactOriginY, s_compactResolution);
+          m_destXLoc = FromGridOffset (i.ReadU16 (), s_compactOriginX, s_compactResolution);
+          m_destYLoc = FromGridOffset (i.ReadU16 (), s_compactOriginY, s_compactResolution);
+        }
+      ReadFrom (i, m_sourceAddress);
+      ReadFrom (i, m_destAddress);
+      m_optionLength = 0;
+      m_segmentsLeft = 0;
+      if (flags & COMPACT_FLAG_WAYPOINTS)
+        {
+          m_optionLength = i.ReadU8 ();
+          m_segmentsLeft = i.ReadU8 ();
+          m_waypoints.resize (m_optionLength);
+          for (std::vector<SiftWaypoint>::iterator it = m_waypoints.begin (); it != m_waypoints.end (); ++it)
+            {
+              if (wide)
+                {
+                  it->x = i.ReadU32 ();
+                  it->y = i.ReadU32 ();
+                }
+              else
+                {
+                  it->x = FromGridOffset (i.ReadU16 (), s_compactOriginX, s_compactResolution);
+                  it->y = FromGridOffset (i.ReadU16 (), s_compactOriginY, s_compactResolution);
+                }
+            }
+        }
+      m_sourceId = 0;
+      m_destId = 0;
+      m_pad = 0;
+      return i.GetDistanceFrom (start);
+    }
   m_optionLength = i.ReadU8 ();
   m_messageType = i.ReadU8 ();
   m_segmentsLeft = i.ReadU8 ();
@@ -364,8 +641,224 @@ uint32_t SiftHeader::Deserialize (Buffer::Iterator start)
   ReadFrom (i, m_sourceAddress);
   ReadFrom (i, m_destAddress);
 
+  m_waypoints.resize (m_optionLength);
+  for (std::vector<SiftWaypoint>::iterator it = m_waypoints.begin (); it != m_waypoints.end (); ++it)
+    {
+      it->x = i.ReadU32 ();
+      it->y = i.ReadU32 ();
+    }
+
   return GetSerializedSize ();
 }
 
+uint32_t SiftHeader::DeserializeKey (Buffer::Iterator start, Ipv4Address &source,
+                                     Ipv4Address &destination, uint16_t &seqNo)
+{
+  Buffer::Iterator i = start;
+  uint8_t first = i.ReadU8 ();
+  uint32_t size = HEADER_SIZE;
+  if (first & COMPACT_FORMAT)
+    {
+      uint8_t flags = i.ReadU8 ();
+      i.Next (2);
+      seqNo = i.ReadU16 ();
+      uint32_t waypointSize = 4;
+      if (!(flags & COMPACT_FLAG_WIDE))
+        {
+          size = COMPACT_HEADER_SIZE;
+        }
+      else
+        {
+          size = COMPACT_WIDE_HEADER_SIZE;
+          waypointSize = 8;
+        }
+      // The addresses end the fixed part of the header
+      i.Next (size - 14);
+      ReadFrom (i, source);
+      ReadFrom (i, destination);
+      if (flags & COMPACT_FLAG_WAYPOINTS)
+        {
+          size += 2 + waypointSize * i.ReadU8 ();
+        }
+      return size;
+    }
+  size += 8 * i.ReadU8 ();
+  i.Next (34);
+  seqNo = i.ReadU16 ();
+  i.Next (2);
+  ReadFrom (i, source);
+  ReadFrom (i, destination);
+  return size;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (SiftBeaconHeader);
+
+/// Size of the first word and of one entry of a beacon
+static const uint32_t BEACON_PREFIX_SIZE = 4;
+static const uint32_t BEACON_ENTRY_SIZE = 18;
+
+TypeId SiftBeaconHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::sift::SiftBeaconHeader")
+    .AddConstructor<SiftBeaconHeader> ()
+    .SetParent<Header> ()
+  ;
+  return tid;
+}
+
+TypeId SiftBeaconHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+SiftBeaconHeader::SiftBeaconHeader ()
+{
+}
+
+SiftBeaconHeader::~SiftBeaconHeader ()
+{
+}
+
+void SiftBeaconHeader::AddEntry (const SiftBeaconEntry &entry)
+{
+  if (m_entries.size () < MAX_ENTRIES)
+    {
+      m_entries.push_back (entry);
+    }
+}
+
+const std::vector<SiftBeaconEntry> & SiftBeaconHeader::GetEntries () const
+{
+  return m_entries;
+}
+
+bool SiftBeaconHeader::IsBeacon (Ptr<const Packet> packet)
+{
+  uint8_t prefix[BEACON_PREFIX_SIZE];
+  if (packet->CopyData (prefix, BEACON_PREFIX_SIZE) < BEACON_PREFIX_SIZE)
+    {
+      return false;
+    }
+  return prefix[2] == MESSAGE_TYPE;
+}
+
+void SiftBeaconHeader::Print (std::ostream &os) const
+{
+  os << " Beacon entries: " << m_entries.size ();
+  for (std::vector<SiftBeaconEntry>::const_iterator it = m_entries.begin (); it != m_entries.end (); ++it)
+    {
+      os << " [" << it->address << " (" << it->xLoc << ", " << it->yLoc << ") v=("
+         << it->xVelocity << ", " << it->yVelocity << ") age=" << it->age << "ms]";
+    }
+}
+
+uint32_t SiftBeaconHeader::GetSerializedSize () const
+{
+  return BEACON_PREFIX_SIZE + BEACON_ENTRY_SIZE * m_entries.size ();
+}
+
+void SiftBeaconHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (0);
+  i.WriteU8 (m_entries.size ());
+  i.WriteU8 (MESSAGE_TYPE);
+  i.WriteU8 (0);
+  for (std::vector<SiftBeaconEntry>::const_iterator it = m_entries.begin (); it != m_entries.end (); ++it)
+    {
+      WriteTo (i, it->address);
+      i.WriteU32 (it->xLoc);
+      i.WriteU32 (it->yLoc);
+      i.WriteU16 (it->xVelocity);
+      i.WriteU16 (it->yVelocity);
+      i.WriteU16 (it->age);
+    }
+}
+
+uint32_t SiftBeaconHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  i.Next ();
+  uint8_t count = i.ReadU8 ();
+  i.Next (2);
+  m_entries.clear ();
+  for (uint8_t n = 0; n < count; ++n)
+    {
+      SiftBeaconEntry entry;
+      ReadFrom (i, entry.address);
+      entry.xLoc = i.ReadU32 ();
+      entry.yLoc = i.ReadU32 ();
+      entry.xVelocity = i.ReadU16 ();
+      entry.yVelocity = i.ReadU16 ();
+      entry.age = i.ReadU16 ();
+      m_entries.push_back (entry);
+    }
+  return GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (SiftKeyHeader);
+
+TypeId SiftKeyHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::sift::SiftKeyHeader")
+    .AddConstructor<SiftKeyHeader> ()
+    .SetParent<Header> ()
+  ;
+  return tid;
+}
+
+TypeId SiftKeyHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+SiftKeyHeader::SiftKeyHeader ()
+  : m_headerSeqNo (0),
+    m_size (0)
+{
+}
+
+SiftKeyHeader::~SiftKeyHeader ()
+{
+}
+
+Ipv4Address SiftKeyHeader::GetSourceAddress () const
+{
+  return m_sourceAddress;
+}
+
+Ipv4Address SiftKeyHeader::GetDestAddress () const
+{
+  return m_destAddress;
+}
+
+uint16_t SiftKeyHeader::GetHeaderSeqNo () const
+{
+  return m_headerSeqNo;
+}
+
+void SiftKeyHeader::Print (std::ostream &os) const
+{
+  os << " Source IP Address: " << m_sourceAddress
+     << " Destination Ip Address: " << m_destAddress
+     << " Seq No= " << m_headerSeqNo;
+}
+
+uint32_t SiftKeyHeader::GetSerializedSize () const
+{
+  return m_size;
+}
+
+void SiftKeyHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_FATAL_ERROR ("SiftKeyHeader is only meant to be peeked");
+}
+
+uint32_t SiftKeyHeader::Deserialize (Buffer::Iterator start)
+{
+  m_size = SiftHeader::DeserializeKey (start, m_sourceAddress, m_destAddress, m_headerSeqNo);
+  return m_size;
+}
+
 }  /* namespace sift */
 }  /* namespace ns3 */
@@ -40,9 +40,31 @@
 
 #include "ns3/header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/packet.h"
 
 namespace ns3 {
 namespace sift {
+/**
+ * \ingroup sift
+ * \brief A point the trajectory of a packet goes through between its source and destination.
+ */
+struct SiftWaypoint
+{
+  int32_t x;  ///< x coordinate of the waypoint
+  int32_t y;  ///< y coordinate of the waypoint
+};
+
+/**
+ * \ingroup sift
+ * \brief Drop the points of a trajectory that lie on the straight line between their neighbors.
+ * \param points the trajectory, first and last point included; both are kept
+ *
+ * A point is dropped when it is exactly on the segment between the last point kept and the
+ * next one, so a straight road through many intersections becomes a single segment. The test
+ * is exact in 64-bit integers for coordinates within 2^30 of 0.
+ */
+void SimplifyTrajectory (std::vector<SiftWaypoint> &points);
+
 /**
  * \class SiftHeader
  * \brief Header for Sift Routing.
@@ -74,6 +96,45 @@ namespace sift {
 +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 |         Seq No              |      TTL      |       Pad       |
 +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                      Waypoint 1 X Coordinate                  |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                      Waypoint 1 Y Coordinate                  |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                             ...                               |
+
+  The Option Length is the number of waypoints. The trajectory goes from the source through
+  the waypoints to the destination, and Segment Left counts the segments of it the packet has
+  not passed yet, the one it is on included.
+
+* Compact format, flagged by the highest bit of the first byte
+        0     |       1       |       2       |       3
+0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|1| Next Header |     Flags     |  Message Type |      TTL      |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|            Seq No             |        Source X Offset        |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|        Source Y Offset        |     Last Source X Offset      |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|     Last Source Y Offset      |     Destination X Offset      |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|     Destination Y Offset      |        Source IP Address      |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|    (Source IP Address)        |    Destination IP Address     |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|  (Destination IP Address)     |   Waypoints   | Segment Left  |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|      Waypoint 1 X Offset      |      Waypoint 1 Y Offset      |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                             ...                               |
+
+  The offsets are signed 16-bit numbers of grid steps from the origin set by SetCompactGrid.
+  When a coordinate is not on that grid or is too far from the origin, the Wide flag is set and
+  the six coordinates are written as 32-bit numbers instead. The source and node ids
+  and the pad are not carried. The waypoint count, the segments left and the waypoints, in the
+  same width as the other coordinates, are only there when the Waypoints flag is set.
+
+  Flags: 0x01 Wide, 0x04 Waypoints
 */
 class SiftHeader : public Header
 {
@@ -178,6 +239,56 @@ public:
   void UpdateHeaderTTL ();
 
 
+  /**
+   * \brief Select the wire format of the header.
+   * \param compact true for the compact format, false for the 48 byte one
+   *
+   * The compact format can only carry a next header below 128.
+   */
+  void SetCompact (bool compact);
+  /**
+   * \brief Get the wire format of the header.
+   * \return true if the header uses the compact format
+   */
+  bool IsCompact () const;
+  /**
+   * \brief Set the grid the coordinates of compact headers are written on.
+   * \param originX x coordinate of the origin of the grid
+   * \param originY y coordinate of the origin of the grid
+   * \param resolution distance in meters between two grid points
+   *
+   * The grid is shared by all the nodes of a simulation and must be set before the first packet
+   * is sent. By default the origin is (0, 0) and the resolution 1 m, which covers every integer
+   * coordinate within 32767 m of the origin.
+   */
+  static void SetCompactGrid (int32_t originX, int32_t originY, uint16_t resolution);
+  /**
+   * \brief Set the waypoints of the trajectory, between the source and the destination.
+   * \param waypoints the waypoints, at most MAX_WAYPOINTS of them
+   *
+   * Also sets the segments left to the number of segments of the trajectory.
+   */
+  void SetWaypoints (const std::vector<SiftWaypoint> &waypoints);
+  /**
+   * \brief Get the waypoints of the trajectory.
+   * \return the waypoints, empty for a straight trajectory
+   */
+  const std::vector<SiftWaypoint> & GetWaypoints () const;
+  /**
+   * \brief Get the segment of the trajectory the packet is on, according to the segments left.
+   * \param x1 set to the x coordinate of the start of the segment
+   * \param y1 set to the y coordinate of the start of the segment
+   * \param x2 set to the x coordinate of the end of the segment
+   * \param y2 set to the y coordinate of the end of the segment
+   *
+   * Without waypoints this is the segment from the source to the destination.
+   */
+  void GetActiveSegment (int32_t &x1, int32_t &y1, int32_t &x2, int32_t &y2) const;
+  /**
+   * \brief Largest number of waypoints in a header
+   */
+  static const uint8_t MAX_WAYPOINTS = 255;
+
   void SetNumberAddress (uint8_t n);
   /**
    * \brief Set the vector of ipv4 address
@@ -232,8 +343,29 @@ public:
    * \return size of the packet
    */
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  /**
+   * \brief Read only the fields that identify a packet, in either format.
+   * \param start Buffer iterator at the start of a serialized header
+   * \param source set to the source address
+   * \param destination set to the destination address
+   * \param seqNo set to the sequence number
+   * \return the size of the whole serialized header
+   *
+   * The fields are at fixed offsets for each format, so the coordinates are skipped.
+   */
+  static uint32_t DeserializeKey (Buffer::Iterator start, Ipv4Address &source,
+                                  Ipv4Address &destination, uint16_t &seqNo);
 
 private:
+  /**
+   * \brief Check whether the coordinates fit in 16-bit grid offsets.
+   * \return true if all six coordinates are on the grid and close enough to its origin
+   */
+  bool FitsCompactGrid () const;
+
+  static int32_t s_compactOriginX;     ///< x coordinate of the origin of the compact grid
+  static int32_t s_compactOriginY;     ///< y coordinate of the origin of the compact grid
+  static uint16_t s_compactResolution; ///< distance between two points of the compact grid
   /**
    * \brief The "next header" field.
    */
@@ -292,6 +424,8 @@ private:
   uint16_t m_headerSeqNo; // SIFT Seq number
   uint8_t m_headerTTL; // SIFT TTL
   uint8_t m_pad; // 1 Byte pad to fit the header to multiple of 4
+  bool m_compact; // Whether the compact format is used
+  std::vector<SiftWaypoint> m_waypoints; // Waypoints of the trajectory
   Ipv4Address m_sourceAddress;
   /**
    * \brief The destination node id
@@ -308,6 +442,134 @@ private:
   VectorIpv4Address_t m_ipv4Address;
 };
 
+/**
+ * \ingroup sift
+ * \brief One node position carried in a beacon.
+ */
+struct SiftBeaconEntry
+{
+  Ipv4Address address;  ///< address of the node
+  int32_t xLoc;         ///< x coordinate of the node
+  int32_t yLoc;         ///< y coordinate of the node
+  int16_t xVelocity;    ///< x velocity of the node in m/s
+  int16_t yVelocity;    ///< y velocity of the node in m/s
+  uint16_t age;         ///< age of the position in milliseconds when the beacon was sent
+};
+
+/**
+* \ingroup sift
+* \brief Sift beacon header Format
+*
+* Beacons share the first word of SiftHeader so that a receiver tells them apart by the
+* message type. The option length holds the number of entries. The first entry is the
+* position of the sender, the others are positions it has heard of.
+*
+        0     |       1       |       2       |       3
+0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|      0      | Entries count |  Message Type |        0        |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                       Node IP Address                         |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                        X Coordinate                           |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                        Y Coordinate                           |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|          X Velocity           |          Y Velocity           |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|              Age              |       next entry ...          |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+*/
+class SiftBeaconHeader : public Header
+{
+public:
+  /**
+   * \brief Message type of a beacon, in the same position as in SiftHeader
+   */
+  static const uint8_t MESSAGE_TYPE = 3;
+  /**
+   * \brief Largest number of entries in one beacon
+   */
+  static const uint8_t MAX_ENTRIES = 255;
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId ();
+  /**
+   * \brief Get the instance type ID.
+   * \return instance type ID
+   */
+  virtual TypeId GetInstanceTypeId () const;
+  SiftBeaconHeader ();
+  virtual ~SiftBeaconHeader ();
+  /**
+   * \brief Append an entry. Entries beyond MAX_ENTRIES are ignored.
+   * \param entry the entry
+   */
+  void AddEntry (const SiftBeaconEntry &entry);
+  /**
+   * \return the entries of the beacon, the sender first
+   */
+  const std::vector<SiftBeaconEntry> & GetEntries () const;
+  /**
+   * \brief Tell whether a SIFT packet starts with a beacon header.
+   * \param packet the packet, starting with a SIFT header of either kind
+   * \return true if the packet is a beacon
+   */
+  static bool IsBeacon (Ptr<const Packet> packet);
+
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize () const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  std::vector<SiftBeaconEntry> m_entries; ///< Positions carried by the beacon
+};
+
+/**
+ * \ingroup sift
+ * \brief Read only view of the key of a SiftHeader.
+ *
+ * Peeking it reads the source, destination and sequence number of a packet without parsing the
+ * rest of the header, so that duplicates can be rejected before the packet is copied.
+ * It cannot be serialized.
+ */
+class SiftKeyHeader : public Header
+{
+public:
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId ();
+  /**
+   * \brief Get the instance type ID.
+   * \return instance type ID
+   */
+  virtual TypeId GetInstanceTypeId () const;
+  SiftKeyHeader ();
+  virtual ~SiftKeyHeader ();
+  /// \return the source address
+  Ipv4Address GetSourceAddress () const;
+  /// \return the destination address
+  Ipv4Address GetDestAddress () const;
+  /// \return the sequence number
+  uint16_t GetHeaderSeqNo () const;
+
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize () const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  Ipv4Address m_sourceAddress;  ///< source address
+  Ipv4Address m_destAddress;    ///< destination address
+  uint16_t m_headerSeqNo;       ///< sequence number
+  uint32_t m_size;              ///< size of the whole header
+};
+
 }  // namespace sift
 }  // namespace ns3
 
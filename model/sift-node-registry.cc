@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ *
+ * James P.G. Sterbenz <jpgs@ittc.ku.edu>, director
+ * ResiliNets Research Group  http://wiki.ittc.ku.edu/resilinets
+ * Information and Telecommunication Technology Center (ITTC)
+ * and Department of Electrical Engineering and Computer Science
+ * The University of Kansas Lawrence, KS USA.
+ */
+
+#include "sift-node-registry.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/ipv4.h"
+
+namespace ns3 {
+namespace sift {
+
+NS_LOG_COMPONENT_DEFINE ("SiftNodeRegistry");
+
+NS_OBJECT_ENSURE_REGISTERED (SiftNodeRegistry);
+
+TypeId
+SiftNodeRegistry::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::sift::SiftNodeRegistry")
+    .SetParent<Object> ()
+    .AddConstructor<SiftNodeRegistry> ()
+  ;
+  return tid;
+}
+
+SiftNodeRegistry::SiftNodeRegistry ()
+  : m_built (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SiftNodeRegistry::~SiftNodeRegistry ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SiftNodeRegistry::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_addresses.clear ();
+  m_unknown.clear ();
+  Object::DoDispose ();
+}
+
+void
+SiftNodeRegistry::Rebuild (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_unknown.clear ();
+  Build ();
+}
+
+void
+SiftNodeRegistry::Build (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_addresses.clear ();
+  for (NodeList::Iterator it = NodeList::Begin (); it != NodeList::End (); ++it)
+    {
+      Ptr<Ipv4> ipv4 = (*it)->GetObject<Ipv4> ();
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      // Interface 0 is the loopback, shared by every node
+      for (uint32_t i = 1; i < ipv4->GetNInterfaces (); ++i)
+        {
+          for (uint32_t j = 0; j < ipv4->GetNAddresses (i); ++j)
+            {
+              Entry entry;
+              entry.node = *it;
+              entry.ipv4 = ipv4;
+              entry.interface = i;
+              // The first node holding an address keeps it, as a scan of NodeList would find it
+              m_addresses.insert (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), entry));
+            }
+        }
+    }
+  m_built = true;
+  m_lastBuild = Simulator::Now ();
+  NS_LOG_DEBUG ("Registry rebuilt with " << m_addresses.size () << " addresses");
+}
+
+const SiftNodeRegistry::Entry *
+SiftNodeRegistry::Find (Ipv4Address address)
+{
+  if (!m_built)
+    {
+      Build ();
+    }
+  AddressTable::const_iterator it = m_addresses.find (address);
+  if (it != m_addresses.end ())
+    {
+      if (it->second.ipv4->GetInterfaceForAddress (address) == it->second.interface)
+        {
+          return &it->second;
+        }
+      // Removed or moved since the last build
+      NS_LOG_DEBUG ("Address " << address << " is no longer on interface " << it->second.interface);
+      Build ();
+      it = m_addresses.find (address);
+    }
+  else if (m_unknown.find (address) == m_unknown.end () && m_lastBuild != Simulator::Now ())
+    {
+      Build ();
+      it = m_addresses.find (address);
+    }
+  if (it == m_addresses.end ())
+    {
+      m_unknown.insert (address);
+      return 0;
+    }
+  return &it->second;
+}
+
+Ptr<Node>
+SiftNodeRegistry::GetNode (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  const Entry *entry = Find (address);
+  return entry == 0 ? Ptr<Node> () : entry->node;
+}
+
+int32_t
+SiftNodeRegistry::GetInterface (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  const Entry *entry = Find (address);
+  return entry == 0 ? -1 : entry->interface;
+}
+
+uint32_t
+SiftNodeRegistry::GetSize (void) const
+{
+  return m_addresses.size ();
+}
+
+} // namespace sift
+} // namespace ns3
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ *
+ * James P.G. Sterbenz <jpgs@ittc.ku.edu>, director
+ * ResiliNets Research Group  http://wiki.ittc.ku.edu/resilinets
+ * Information and Telecommunication Technology Center (ITTC)
+ * and Department of Electrical Engineering and Computer Science
+ * The University of Kansas Lawrence, KS USA.
+ */
+
+#ifndef SIFT_NODE_REGISTRY_H
+#define SIFT_NODE_REGISTRY_H
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4.h"
+#include "sift-repository.h"
+
+namespace ns3 {
+namespace sift {
+
+/**
+ * \ingroup sift
+ * \class SiftNodeRegistry
+ * \brief Maps the IPv4 addresses of the simulation to their node and interface.
+ *
+ * One registry is created by SiftHelper and shared by all the agents it installs. It is
+ * filled from NodeList on the first lookup. Addresses are usually assigned after SIFT is
+ * installed, so the first lookup of an unknown address rebuilds the table, at most once
+ * per simulation time, to pick up addresses assigned since the last build. An address
+ * still unknown after that is remembered as such, and later lookups of it return at once
+ * until Rebuild is called. A hit is checked against the interface of its node, so an
+ * address removed or moved since the last build rebuilds the table instead of returning
+ * a stale node.
+ */
+class SiftNodeRegistry : public Object
+{
+public:
+  /**
+   * \brief Get the type identifier.
+   * \return type identifier
+   */
+  static TypeId GetTypeId (void);
+
+  SiftNodeRegistry ();
+  virtual ~SiftNodeRegistry ();
+
+  /**
+   * \param address an address assigned to an interface of a node
+   * \returns the node owning address, or 0 if no node has it
+   */
+  Ptr<Node> GetNode (Ipv4Address address);
+  /**
+   * \param address an address assigned to an interface of a node
+   * \returns the index of the interface holding address on its node, or -1 if no node has it
+   */
+  int32_t GetInterface (Ipv4Address address);
+  /**
+   * \brief Rebuild the table from the addresses currently assigned in NodeList, and forget
+   * the addresses found to be unknown. Call it after addresses are assigned during a simulation.
+   */
+  void Rebuild (void);
+  /**
+   * \returns the number of addresses in the table
+   */
+  uint32_t GetSize (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// Node and interface of an address
+  struct Entry
+  {
+    Ptr<Node> node;
+    Ptr<Ipv4> ipv4;
+    int32_t interface;
+  };
+  typedef std::unordered_map<Ipv4Address, Entry, Ipv4AddressHash> AddressTable;
+  typedef std::unordered_set<Ipv4Address, Ipv4AddressHash> AddressSet;
+
+  /// Fill the table from NodeList, keeping the unknown addresses
+  void Build (void);
+  /// Entry of address, rebuilding the table first if address is unknown; 0 if not found
+  const Entry * Find (Ipv4Address address);
+
+  AddressTable m_addresses;  ///< Address -> node and interface
+  AddressSet m_unknown;      ///< Addresses not found since the last call to Rebuild
+  bool m_built;              ///< Whether the table has been built at least once
+  Time m_lastBuild;          ///< Simulation time of the last build
+};
+
+} // namespace sift
+} // namespace ns3
+
+#endif /* SIFT_NODE_REGISTRY_H */
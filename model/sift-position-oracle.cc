@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ *
+ * James P.G. Sterbenz <jpgs@ittc.ku.edu>, director
+ * ResiliNets Research Group  http://wiki.ittc.ku.edu/resilinets
+ * Information and Telecommunication Technology Center (ITTC)
+ * and Department of Electrical Engineering and Computer Science
+ * The University of Kansas Lawrence, KS USA.
+ */
+
+#include "sift-position-oracle.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/ipv4.h"
+
+namespace ns3 {
+namespace sift {
+
+NS_LOG_COMPONENT_DEFINE ("SiftPositionOracle");
+
+NS_OBJECT_ENSURE_REGISTERED (SiftPositionOracle);
+
+TypeId
+SiftPositionOracle::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::sift::SiftPositionOracle")
+    .SetParent<Object> ()
+    .AddConstructor<SiftPositionOracle> ()
+  ;
+  return tid;
+}
+
+SiftPositionOracle::SiftPositionOracle ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SiftPositionOracle::~SiftPositionOracle ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SiftPositionOracle::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_entries.clear ();
+  m_index.clear ();
+  Object::DoDispose ();
+}
+
+void
+SiftPositionOracle::AddNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  NS_ASSERT (node != 0);
+  if (!m_index.insert (std::make_pair (node->GetId (), m_entries.size ())).second)
+    {
+      return;
+    }
+  Entry entry;
+  entry.node = node;
+  entry.valid = false;
+  m_entries.push_back (entry);
+}
+
+uint32_t
+SiftPositionOracle::GetNNodes (void) const
+{
+  return m_entries.size ();
+}
+
+Ptr<Node>
+SiftPositionOracle::GetNode (uint32_t index) const
+{
+  NS_ASSERT (index < m_entries.size ());
+  return m_entries[index].node;
+}
+
+int32_t
+SiftPositionOracle::GetIndex (uint32_t nodeId) const
+{
+  std::unordered_map<uint32_t, uint32_t>::const_iterator it = m_index.find (nodeId);
+  if (it == m_index.end ())
+    {
+      return -1;
+    }
+  return it->second;
+}
+
+Ipv4Address
+SiftPositionOracle::GetAddress (uint32_t index)
+{
+  NS_ASSERT (index < m_entries.size ());
+  Entry &entry = m_entries[index];
+  // Addresses are usually assigned after the nodes are added
+  if (entry.address == Ipv4Address ())
+    {
+      Ptr<Ipv4> ipv4 = entry.node->GetObject<Ipv4> ();
+      if (ipv4 != 0 && ipv4->GetNInterfaces () > 1)
+        {
+          entry.address = ipv4->GetAddress (1, 0).GetLocal ();
+        }
+    }
+  return entry.address;
+}
+
+const Vector &
+SiftPositionOracle::GetPosition (uint32_t index)
+{
+  return Refresh (index).position;
+}
+
+const Vector &
+SiftPositionOracle::GetVelocity (uint32_t index)
+{
+  return Refresh (index).velocity;
+}
+
+SiftPositionOracle::Entry &
+SiftPositionOracle::Refresh (uint32_t index)
+{
+  NS_ASSERT (index < m_entries.size ());
+  Entry &entry = m_entries[index];
+  Time now = Simulator::Now ();
+  if (entry.valid && entry.updated == now)
+    {
+      return entry;
+    }
+  if (entry.mobility == 0)
+    {
+      entry.mobility = entry.node->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (entry.mobility != 0, "SIFT node " << entry.node->GetId () << " has no mobility model");
+    }
+  entry.position = entry.mobility->GetPosition ();
+  entry.velocity = entry.mobility->GetVelocity ();
+  entry.updated = now;
+  entry.valid = true;
+  return entry;
+}
+
+} // namespace sift
+} // namespace ns3
@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ *
+ * James P.G. Sterbenz <jpgs@ittc.ku.edu>, director
+ * ResiliNets Research Group  http://wiki.ittc.ku.edu/resilinets
+ * Information and Telecommunication Technology Center (ITTC)
+ * and Department of Electrical Engineering and Computer Science
+ * The University of Kansas Lawrence, KS USA.
+ */
+
+#ifndef SIFT_POSITION_ORACLE_H
+#define SIFT_POSITION_ORACLE_H
+
+#include <vector>
+#include <unordered_map>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+namespace sift {
+
+/**
+ * \ingroup sift
+ * \class SiftPositionOracle
+ * \brief Position and velocity of every SIFT node, shared by all the agents.
+ *
+ * SiftHelper creates one oracle and registers every node given to SetNodes with it, so the
+ * node list is kept once for the whole simulation instead of once per agent. Nodes are
+ * addressed by their index in the oracle. The position and velocity of a node are read
+ * from its mobility model on the first request at a given simulation time and served from
+ * the oracle for the other requests at that time.
+ */
+class SiftPositionOracle : public Object
+{
+public:
+  /**
+   * \brief Get the type identifier.
+   * \return type identifier
+   */
+  static TypeId GetTypeId (void);
+
+  SiftPositionOracle ();
+  virtual ~SiftPositionOracle ();
+
+  /**
+   * \brief Add a node to the oracle. A node that is already known is ignored.
+   * \param node the node
+   */
+  void AddNode (Ptr<Node> node);
+  /**
+   * \returns the number of nodes in the oracle
+   */
+  uint32_t GetNNodes (void) const;
+  /**
+   * \param index index of a node in the oracle
+   * \returns the node
+   */
+  Ptr<Node> GetNode (uint32_t index) const;
+  /**
+   * \param nodeId the id of a node
+   * \returns the index of the node in the oracle, or -1 if it is not in the oracle
+   */
+  int32_t GetIndex (uint32_t nodeId) const;
+  /**
+   * \param index index of a node in the oracle
+   * \returns the primary address of the node, 0.0.0.0 if it has none yet
+   */
+  Ipv4Address GetAddress (uint32_t index);
+  /**
+   * \param index index of a node in the oracle
+   * \returns the position of the node at the current simulation time
+   */
+  const Vector & GetPosition (uint32_t index);
+  /**
+   * \param index index of a node in the oracle
+   * \returns the velocity of the node at the current simulation time
+   */
+  const Vector & GetVelocity (uint32_t index);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// What is known about one node
+  struct Entry
+  {
+    Ptr<Node> node;                   ///< the node
+    Ptr<MobilityModel> mobility;      ///< its mobility model, looked up on first use
+    Ipv4Address address;              ///< its primary address, looked up on first use
+    Vector position;                  ///< position at time updated
+    Vector velocity;                  ///< velocity at time updated
+    Time updated;                     ///< when position and velocity were read
+    bool valid;                       ///< whether position and velocity were read at all
+  };
+
+  /// Read the position and velocity of an entry unless they were read at the current time
+  Entry & Refresh (uint32_t index);
+
+  std::vector<Entry> m_entries;                             ///< One entry per node
+  std::unordered_map<uint32_t, uint32_t> m_index;           ///< Node id -> index in m_entries
+};
+
+} // namespace sift
+} // namespace ns3
+
+#endif /* SIFT_POSITION_ORACLE_H */
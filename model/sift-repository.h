@@ -94,6 +94,42 @@ operator << (std::ostream &os, const GeographicTuple &tuple)
 
 typedef std::vector<GeographicTuple> GeographicSet; ///< Geographic Set type.
 
+/// Identifies one SiFT data packet end to end: the origin, the final
+/// destination and the sequence number stamped by the origin.
+struct SiftPacketKey
+{
+  Ipv4Address source;
+  Ipv4Address destination;
+  uint16_t seqNo;
+};
+
+static inline bool
+operator == (const SiftPacketKey &a, const SiftPacketKey &b)
+{
+  return (a.seqNo == b.seqNo && a.source == b.source && a.destination == b.destination);
+}
+
+static inline std::ostream&
+operator << (std::ostream &os, const SiftPacketKey &key)
+{
+  os << "SiftPacketKey(source=" << key.source
+     << ", destination=" << key.destination
+     << ", seqNo=" << key.seqNo << ")";
+  return os;
+}
+
+/// Hash functor so that SiftPacketKey can index unordered containers.
+struct SiftPacketKeyHash
+{
+  size_t operator() (const SiftPacketKey &key) const
+  {
+    uint64_t h = key.source.Get ();
+    h = h * 0x9E3779B97F4A7C15ULL + key.destination.Get ();
+    h = h * 0x9E3779B97F4A7C15ULL + key.seqNo;
+    return static_cast<size_t> (h ^ (h >> 32));
+  }
+};
+
 } // namespace sift
 }  // namespace ns3
 
@@ -0,0 +1,334 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ *
+ * James P.G. Sterbenz <jpgs@ittc.ku.edu>, director
+ * ResiliNets Research Group  http://wiki.ittc.ku.edu/resilinets
+ * Information and Telecommunication Technology Center (ITTC)
+ * and Department of Electrical Engineering and Computer Science
+ * The University of Kansas Lawrence, KS USA.
+ */
+
+
+#include "sift-road-map.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include <fstream>
+#include <sstream>
+#include <queue>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+namespace ns3 {
+namespace sift {
+
+NS_LOG_COMPONENT_DEFINE ("SiftRoadMap");
+
+NS_OBJECT_ENSURE_REGISTERED (SiftRoadMap);
+
+/// Pack two signed 32-bit numbers into one key
+static uint64_t
+PackKey (int32_t x, int32_t y)
+{
+  return (static_cast<uint64_t> (static_cast<uint32_t> (x)) << 32) | static_cast<uint32_t> (y);
+}
+
+TypeId
+SiftRoadMap::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::sift::SiftRoadMap")
+    .SetParent<Object> ()
+    .AddConstructor<SiftRoadMap> ()
+    .AddAttribute ("CellSize",
+                   "Side in meters of the cells the waypoints are computed and cached for.",
+                   DoubleValue (250),
+                   MakeDoubleAccessor (&SiftRoadMap::SetCellSize,
+                                       &SiftRoadMap::GetCellSize),
+                   MakeDoubleChecker<double> (1))
+    .AddAttribute ("MaxCachedRoutes",
+                   "Number of cell pairs whose waypoints are cached. The cache is emptied when it is full.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&SiftRoadMap::SetMaxCachedRoutes,
+                                         &SiftRoadMap::GetMaxCachedRoutes),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+SiftRoadMap::SiftRoadMap ()
+  : m_cellSize (250),
+    m_maxCachedRoutes (65536)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SiftRoadMap::~SiftRoadMap ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SiftRoadMap::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_intersections.clear ();
+  m_roads.clear ();
+  m_index.clear ();
+  ClearCache ();
+  Object::DoDispose ();
+}
+
+uint32_t
+SiftRoadMap::Load (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ifstream file (fileName.c_str ());
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Can not open road map " << fileName);
+    }
+  uint32_t roads = 0;
+  uint32_t lineNumber = 0;
+  std::string line;
+  while (std::getline (file, line))
+    {
+      ++lineNumber;
+      std::string::size_type first = line.find_first_not_of (" \t\r");
+      if (first == std::string::npos || line[first] == '#')
+        {
+          continue;
+        }
+      std::istringstream fields (line);
+      double x1, y1, x2, y2;
+      if (!(fields >> x1 >> y1 >> x2 >> y2))
+        {
+          NS_LOG_WARN ("Skipping malformed line " << lineNumber << " of " << fileName);
+          continue;
+        }
+      AddRoad (Vector (x1, y1, 0), Vector (x2, y2, 0));
+      ++roads;
+    }
+  NS_LOG_DEBUG (roads << " roads and " << m_intersections.size () << " intersections read from " << fileName);
+  return roads;
+}
+
+void
+SiftRoadMap::AddRoad (const Vector &from, const Vector &to)
+{
+  NS_LOG_FUNCTION (this << from << to);
+  uint32_t a = AddIntersection (std::floor (from.x + 0.5), std::floor (from.y + 0.5));
+  uint32_t b = AddIntersection (std::floor (to.x + 0.5), std::floor (to.y + 0.5));
+  if (a == b)
+    {
+      return;
+    }
+  double dx = m_intersections[a].x - m_intersections[b].x;
+  double dy = m_intersections[a].y - m_intersections[b].y;
+  Road road;
+  road.length = std::sqrt (dx * dx + dy * dy);
+  road.to = b;
+  m_roads[a].push_back (road);
+  road.to = a;
+  m_roads[b].push_back (road);
+  ClearCache ();
+}
+
+uint32_t
+SiftRoadMap::AddIntersection (int32_t x, int32_t y)
+{
+  std::pair<std::unordered_map<uint64_t, uint32_t>::iterator, bool> inserted =
+    m_index.insert (std::make_pair (PackKey (x, y), m_intersections.size ()));
+  if (inserted.second)
+    {
+      SiftWaypoint intersection;
+      intersection.x = x;
+      intersection.y = y;
+      m_intersections.push_back (intersection);
+      m_roads.push_back (std::vector<Road> ());
+    }
+  return inserted.first->second;
+}
+
+uint32_t
+SiftRoadMap::GetNIntersections (void) const
+{
+  return m_intersections.size ();
+}
+
+uint32_t
+SiftRoadMap::GetNCachedRoutes (void) const
+{
+  return m_routes.size ();
+}
+
+void
+SiftRoadMap::SetCellSize (double cellSize)
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT (cellSize > 0);
+  m_cellSize = cellSize;
+  ClearCache ();
+}
+
+double
+SiftRoadMap::GetCellSize (void) const
+{
+  return m_cellSize;
+}
+
+void
+SiftRoadMap::SetMaxCachedRoutes (uint32_t maxCachedRoutes)
+{
+  NS_LOG_FUNCTION (this << maxCachedRoutes);
+  NS_ASSERT (maxCachedRoutes > 0);
+  m_maxCachedRoutes = maxCachedRoutes;
+  m_routes.clear ();
+}
+
+uint32_t
+SiftRoadMap::GetMaxCachedRoutes (void) const
+{
+  return m_maxCachedRoutes;
+}
+
+void
+SiftRoadMap::ClearCache (void)
+{
+  m_nearest.clear ();
+  m_routes.clear ();
+}
+
+uint64_t
+SiftRoadMap::GetCell (const Vector &position) const
+{
+  return PackKey (static_cast<int32_t> (std::floor (position.x / m_cellSize)),
+                  static_cast<int32_t> (std::floor (position.y / m_cellSize)));
+}
+
+uint32_t
+SiftRoadMap::GetNearestIntersection (uint64_t cell)
+{
+  std::unordered_map<uint64_t, uint32_t>::const_iterator it = m_nearest.find (cell);
+  if (it != m_nearest.end ())
+    {
+      return it->second;
+    }
+  double centerX = (static_cast<int32_t> (cell >> 32) + 0.5) * m_cellSize;
+  double centerY = (static_cast<int32_t> (cell & 0xffffffff) + 0.5) * m_cellSize;
+  uint32_t nearest = 0;
+  double best = std::numeric_limits<double>::max ();
+  for (uint32_t i = 0; i < m_intersections.size (); ++i)
+    {
+      double dx = m_intersections[i].x - centerX;
+      double dy = m_intersections[i].y - centerY;
+      double distance = dx * dx + dy * dy;
+      if (distance < best)
+        {
+          best = distance;
+          nearest = i;
+        }
+    }
+  m_nearest.insert (std::make_pair (cell, nearest));
+  return nearest;
+}
+
+void
+SiftRoadMap::ShortestPath (uint32_t from, uint32_t to, std::vector<SiftWaypoint> &waypoints) const
+{
+  std::vector<double> distance (m_intersections.size (), std::numeric_limits<double>::max ());
+  std::vector<uint32_t> previous (m_intersections.size (), m_intersections.size ());
+  typedef std::pair<double, uint32_t> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+  distance[from] = 0;
+  queue.push (QueueEntry (0, from));
+  while (!queue.empty ())
+    {
+      QueueEntry top = queue.top ();
+      queue.pop ();
+      if (top.second == to)
+        {
+          break;
+        }
+      if (top.first > distance[top.second])
+        {
+          continue;
+        }
+      const std::vector<Road> &roads = m_roads[top.second];
+      for (std::vector<Road>::const_iterator road = roads.begin (); road != roads.end (); ++road)
+        {
+          double d = top.first + road->length;
+          if (d < distance[road->to])
+            {
+              distance[road->to] = d;
+              previous[road->to] = top.second;
+              queue.push (QueueEntry (d, road->to));
+            }
+        }
+    }
+  waypoints.clear ();
+  if (distance[to] == std::numeric_limits<double>::max ())
+    {
+      return;
+    }
+  for (uint32_t i = to; i != from; i = previous[i])
+    {
+      waypoints.push_back (m_intersections[i]);
+    }
+  waypoints.push_back (m_intersections[from]);
+  std::reverse (waypoints.begin (), waypoints.end ());
+}
+
+std::vector<SiftWaypoint>
+SiftRoadMap::GetWaypoints (Vector source, Vector destination)
+{
+  NS_LOG_FUNCTION (this << source << destination);
+  uint64_t sourceCell = GetCell (source);
+  uint64_t destinationCell = GetCell (destination);
+  if (m_intersections.empty () || sourceCell == destinationCell)
+    {
+      return std::vector<SiftWaypoint> ();
+    }
+  std::pair<uint64_t, uint64_t> key (sourceCell, destinationCell);
+  RouteCache::const_iterator it = m_routes.find (key);
+  if (it != m_routes.end ())
+    {
+      return it->second;
+    }
+  std::vector<SiftWaypoint> waypoints;
+  uint32_t from = GetNearestIntersection (sourceCell);
+  uint32_t to = GetNearestIntersection (destinationCell);
+  if (from != to)
+    {
+      ShortestPath (from, to, waypoints);
+      SimplifyTrajectory (waypoints);
+    }
+  if (m_routes.size () >= m_maxCachedRoutes)
+    {
+      NS_LOG_DEBUG ("Route cache full with " << m_routes.size () << " cell pairs, emptying it");
+      m_routes.clear ();
+    }
+  m_routes.insert (std::make_pair (key, waypoints));
+  return waypoints;
+}
+
+} // namespace sift
+} // namespace ns3
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Amir Modarresi
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Amir Modarresi   <amodarresi@ittc.ku.edu>
+ *
+ * James P.G. Sterbenz <jpgs@ittc.ku.edu>, director
+ * ResiliNets Research Group  http://wiki.ittc.ku.edu/resilinets
+ * Information and Telecommunication Technology Center (ITTC)
+ * and Department of Electrical Engineering and Computer Science
+ * The University of Kansas Lawrence, KS USA.
+ */
+
+
+#ifndef SIFT_ROAD_MAP_H
+#define SIFT_ROAD_MAP_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+
+#include "ns3/object.h"
+#include "ns3/vector.h"
+#include "sift-header.h"
+
+namespace ns3 {
+namespace sift {
+
+/**
+ * \ingroup sift
+ * \class SiftRoadMap
+ * \brief Road graph the sources use to plan the waypoints of their trajectories.
+ *
+ * The graph is read once from an edge list and shared by all the agents of a SiftHelper.
+ * A trajectory goes from the intersection nearest to the source cell, along the shortest
+ * path over the roads, to the intersection nearest to the destination cell. The area is
+ * divided in square cells of CellSize meters and the waypoints are computed once for each
+ * pair of source and destination cells, then served from a cache. Intersections on the
+ * straight line between the previous and the next waypoint are left out. The cache holds
+ * at most MaxCachedRoutes cell pairs, the square of the number of cells in the worst case,
+ * but only the pairs packets are sent between in practice; it is emptied when full.
+ */
+class SiftRoadMap : public Object
+{
+public:
+  /**
+   * \brief Get the type identifier.
+   * \return type identifier
+   */
+  static TypeId GetTypeId (void);
+
+  SiftRoadMap ();
+  virtual ~SiftRoadMap ();
+
+  /**
+   * \brief Read roads from an edge list file.
+   * \param fileName the file
+   * \returns the number of roads read
+   *
+   * Each line holds one two-way road as the coordinates of its end intersections,
+   * "x1 y1 x2 y2", in meters. Intersections are matched by their coordinates rounded
+   * to the meter. Empty lines and lines starting with '#' are skipped.
+   */
+  uint32_t Load (std::string fileName);
+  /**
+   * \brief Add a two-way road between two intersections.
+   * \param from one end of the road
+   * \param to the other end of the road
+   */
+  void AddRoad (const Vector &from, const Vector &to);
+  /**
+   * \returns the number of intersections
+   */
+  uint32_t GetNIntersections (void) const;
+  /**
+   * \returns the number of cell pairs whose waypoints are cached
+   */
+  uint32_t GetNCachedRoutes (void) const;
+  /**
+   * \brief Get the waypoints of the trajectory between two positions.
+   * \param source position of the source
+   * \param destination position of the destination
+   * \returns the intersections where the trajectory turns, empty when both positions are in
+   * the same cell, lead to the same intersection or are not connected by roads
+   *
+   * Matches SiftRouting::WaypointCallback.
+   */
+  std::vector<SiftWaypoint> GetWaypoints (Vector source, Vector destination);
+
+  /**
+   * \param cellSize side of the cells the routes are cached for, in meters
+   */
+  void SetCellSize (double cellSize);
+  /**
+   * \returns the side of the cells the routes are cached for, in meters
+   */
+  double GetCellSize (void) const;
+  /**
+   * \param maxCachedRoutes number of cell pairs whose waypoints are cached
+   */
+  void SetMaxCachedRoutes (uint32_t maxCachedRoutes);
+  /**
+   * \returns the number of cell pairs whose waypoints are cached
+   */
+  uint32_t GetMaxCachedRoutes (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// A road leaving an intersection
+  struct Road
+  {
+    uint32_t to;      ///< intersection at the other end
+    double length;    ///< length of the road
+  };
+  /// Hash of a pair of cells
+  struct CellPairHash
+  {
+    size_t operator() (const std::pair<uint64_t, uint64_t> &cells) const
+    {
+      return std::hash<uint64_t> () (cells.first * 0x9E3779B97F4A7C15ULL ^ cells.second);
+    }
+  };
+  typedef std::unordered_map<std::pair<uint64_t, uint64_t>, std::vector<SiftWaypoint>, CellPairHash> RouteCache;
+
+  /**
+   * \brief Find or create the intersection at some coordinates.
+   * \returns its index
+   */
+  uint32_t AddIntersection (int32_t x, int32_t y);
+  /**
+   * \returns the key of the cell a position is in
+   */
+  uint64_t GetCell (const Vector &position) const;
+  /**
+   * \returns the index of the intersection nearest to the center of a cell
+   */
+  uint32_t GetNearestIntersection (uint64_t cell);
+  /**
+   * \brief Dijkstra search over the roads.
+   * \param from index of the first intersection
+   * \param to index of the last intersection
+   * \param waypoints filled with the intersections of the shortest path, both ends included,
+   * left empty if there is none
+   */
+  void ShortestPath (uint32_t from, uint32_t to, std::vector<SiftWaypoint> &waypoints) const;
+  /// Forget the routes and nearest intersections computed so far
+  void ClearCache (void);
+
+  std::vector<SiftWaypoint> m_intersections;                ///< Coordinates of each intersection
+  std::vector<std::vector<Road> > m_roads;                  ///< Roads leaving each intersection
+  std::unordered_map<uint64_t, uint32_t> m_index;           ///< Packed coordinates -> intersection
+  std::unordered_map<uint64_t, uint32_t> m_nearest;         ///< Cell -> nearest intersection
+  RouteCache m_routes;                                      ///< Waypoints for each pair of cells
+  double m_cellSize;                                        ///< Side of a cell
+  uint32_t m_maxCachedRoutes;                               ///< Largest number of cell pairs in m_routes
+};
+
+} // namespace sift
+} // namespace ns3
+
+#endif /* SIFT_ROAD_MAP_H */
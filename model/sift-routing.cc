@@ -37,14 +37,13 @@
 #define GRE_PROTOCOL 47
 #define MAX_SEQ_NO 65536
 #define TTL 64
-#define ALPHA 0.01
-static const double TRANSMISSION_TIME=0.000047;
 
 #include <list>
 #include <ctime>
 #include <map>
 #include <limits>
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <float.h>
 //#include "ns3/config.h"
@@ -84,6 +83,7 @@ static const double TRANSMISSION_TIME=0.000047;
 #include "sift-routing.h"
 #include "sift-header.h"
 #include "sift-geo.h"
+#include "sift-geometry.h"
 
 NS_LOG_COMPONENT_DEFINE ("SiftRouting");
 
@@ -95,6 +95,7 @@ NS_OBJECT_ENSURE_REGISTERED (SiftRouting);
 
 /* see http://www.iana.org/assignments/protocol-numbers */
 const uint8_t SiftRouting::PROT_NUMBER = 47;
+const uint32_t SiftRouting::INVALID_NODE_ID = std::numeric_limits<uint32_t>::max ();
 /*
  * The extension header is the sift header, it is response for recognizing SIFT option types
  * and demux to right options to process the packet.
@@ -117,18 +118,240 @@ TypeId SiftRouting::GetTypeId ()
   static TypeId tid = TypeId ("ns3::sift::SiftRouting")
     .SetParent<IpL4Protocol> ()
     .AddConstructor<SiftRouting> ()
-    .AddTraceSource ("Tx", "Send SIFT packet.",
+    .AddAttribute ("DuplicateLifetime",
+                   "How long a received packet is remembered to suppress its duplicates, and how long "
+                   "the sequence window of an origin is kept without a new packet.",
+                   TimeValue (Seconds (3)),
+                   MakeTimeAccessor (&SiftRouting::SetDuplicateLifetime,
+                                     &SiftRouting::GetDuplicateLifetime),
+                   MakeTimeChecker ())
+    .AddAttribute ("DuplicateDetection",
+                   "How received packets are checked for duplicates: an exact cache of packet keys, "
+                   "or a sliding sequence number window per origin.",
+                   EnumValue (SiftRouting::DUPLICATE_CACHE),
+                   MakeEnumAccessor (&SiftRouting::m_duplicateDetection),
+                   MakeEnumChecker (SiftRouting::DUPLICATE_CACHE, "Cache",
+                                    SiftRouting::SEQUENCE_WINDOW, "Window",
+                                    SiftRouting::BLOOM_FILTER, "Bloom"))
+    .AddAttribute ("GeoRefreshInterval",
+                   "Interval at which the positions of all known nodes are refreshed in the geographic set. "
+                   "Zero disables the periodic refresh; only the position of the receiving node is "
+                   "then refreshed, when it relays a packet.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&SiftRouting::m_geoRefreshInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("PredictionStaleness",
+                   "Age up to which the position of a destination is predicted from its last known "
+                   "position and velocity instead of being read from its mobility model. "
+                   "Zero disables the prediction.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&SiftRouting::m_predictionStaleness),
+                   MakeTimeChecker ())
+    .AddAttribute ("LocationService",
+                   "Where the source of a packet finds the position of its destination: its mobility "
+                   "model, or the positions learned from the beacons of the other nodes.",
+                   EnumValue (SiftRouting::ORACLE_LOCATION),
+                   MakeEnumAccessor (&SiftRouting::m_locationService),
+                   MakeEnumChecker (SiftRouting::ORACLE_LOCATION, "Oracle",
+                                    SiftRouting::BEACON_LOCATION, "Beacon"))
+    .AddAttribute ("BeaconInterval",
+                   "Interval between two position beacons of a node, with the Beacon location service.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&SiftRouting::m_beaconInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("BeaconSuppressionDistance",
+                   "A beacon is not sent while the position the neighbors extrapolate from the last one "
+                   "is within this distance, in meters, of the real position. Zero sends every beacon.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&SiftRouting::m_beaconSuppressionDistance),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("BeaconMaxInterval",
+                   "Longest time between two beacons of a node when beacons are suppressed.",
+                   TimeValue (Seconds (5)),
+                   MakeTimeAccessor (&SiftRouting::m_beaconMaxInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("BeaconGossipEntries",
+                   "Number of positions of other nodes, the freshest known, carried by a beacon.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&SiftRouting::m_beaconGossipEntries),
+                   MakeUintegerChecker<uint32_t> (0, SiftBeaconHeader::MAX_ENTRIES - 1))
+    .AddAttribute ("LocationTimeout",
+                   "Age after which a position learned from beacons is no longer used.",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&SiftRouting::m_locationTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("TrajectoryCacheLifetime",
+                   "Time a source reuses the trajectory, the positions in the header, it built for a "
+                   "destination. Zero rebuilds it for every packet.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&SiftRouting::m_trajectoryCacheLifetime),
+                   MakeTimeChecker ())
+    .AddAttribute ("TrajectoryCacheDistance",
+                   "Distance in meters the source, or the known position of the destination, may "
+                   "move before the trajectory cached for that destination is rebuilt.",
+                   DoubleValue (10),
+                   MakeDoubleAccessor (&SiftRouting::m_trajectoryCacheDistance),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("CompactHeader",
+                   "Send packets with the compact header format, whose coordinates are offsets on the "
+                   "grid set by SiftHeader::SetCompactGrid, instead of the 48 byte header.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&SiftRouting::m_compactHeader),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CorridorWidth",
+                   "Largest distance in meters from the trajectory at which a node relays a packet, "
+                   "usually the radio range. Farther nodes drop the packet when they receive it.",
+                   DoubleValue (250),
+                   MakeDoubleAccessor (&SiftRouting::m_corridorWidth),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("DelayPolicy",
+                   "How a relay sets its contention timer: the distance from the trajectory over the "
+                   "distance from the last sender, the advance along the trajectory, the distance from "
+                   "the trajectory only, or the ratio scaled by the number of neighbors.",
+                   EnumValue (SiftRouting::RATIO_DELAY),
+                   MakeEnumAccessor (&SiftRouting::m_delayPolicy),
+                   MakeEnumChecker (SiftRouting::RATIO_DELAY, "Ratio",
+                                    SiftRouting::PROGRESS_DELAY, "Progress",
+                                    SiftRouting::DISTANCE_DELAY, "Distance",
+                                    SiftRouting::DENSITY_DELAY, "Density"))
+    .AddAttribute ("Alpha",
+                   "Scale in seconds of the weight given by the delay policy to a relay.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&SiftRouting::m_alpha),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("TransmissionTime",
+                   "Shortest contention delay of a relay, the time of one transmission.",
+                   TimeValue (MicroSeconds (47)),
+                   MakeTimeAccessor (&SiftRouting::m_transmissionTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("DensityReference",
+                   "Number of neighbors at which the Density delay policy gives the same delay as Ratio.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&SiftRouting::m_referenceNeighbors),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxJitter",
+                   "Largest random delay added to the contention timer of a relay, so that relays with "
+                   "the same weight do not forward at the same time. Zero disables the jitter. "
+                   "The random stream is set with SiftRouting::AssignStreams.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&SiftRouting::m_maxJitter),
+                   MakeTimeChecker ())
+    .AddAttribute ("CollisionWindow",
+                   "Time after its own forward within which a relay that hears the copy of another "
+                   "relay reports a timer collision. It must cover the airtime of both frames and "
+                   "the channel access deferral of the second one.",
+                   TimeValue (MilliSeconds (2)),
+                   MakeTimeAccessor (&SiftRouting::m_collisionWindow),
+                   MakeTimeChecker ())
+    .AddAttribute ("DensityMinScale",
+                   "Smallest factor by which the Density delay policy scales the weight of a relay "
+                   "with few neighbors.",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&SiftRouting::m_densityMinScale),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("DensityMaxScale",
+                   "Largest factor by which the Density delay policy scales the weight of a relay "
+                   "with many neighbors.",
+                   DoubleValue (4),
+                   MakeDoubleAccessor (&SiftRouting::m_densityMaxScale),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("DensityEstimate",
+                   "How the Density delay policy counts the neighbors of a relay: the known nodes of "
+                   "the geographic set within CorridorWidth, or the distinct senders of the SiFT frames "
+                   "heard within DensityWindow. Geo needs the Beacon location service or a positive "
+                   "GeoRefreshInterval, and falls back to Overheard otherwise.",
+                   EnumValue (SiftRouting::GEO_DENSITY),
+                   MakeEnumAccessor (&SiftRouting::m_densityEstimate),
+                   MakeEnumChecker (SiftRouting::GEO_DENSITY, "Geo",
+                                    SiftRouting::OVERHEARD_DENSITY, "Overheard"))
+    .AddAttribute ("DensityWindow",
+                   "Time during which the sender of a SiFT frame heard by a relay counts as a neighbor.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&SiftRouting::m_densityWindow),
+                   MakeTimeChecker ())
+    .AddAttribute ("GeoGridCellSize",
+                   "Side in meters of a cell of the spatial index over the geographic set, "
+                   "usually the radio range.",
+                   DoubleValue (250),
+                   MakeDoubleAccessor (&SiftRouting::SetGeoGridCellSize,
+                                       &SiftRouting::GetGeoGridCellSize),
+                   MakeDoubleChecker<double> (1))
+    .AddAttribute ("BloomCapacity",
+                   "Number of packets one generation of the Bloom duplicate filter is sized for.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&SiftRouting::SetBloomCapacity,
+                                         &SiftRouting::GetBloomCapacity),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BloomFalsePositiveRate",
+                   "Target false positive rate of a full generation of the Bloom duplicate filter.",
+                   DoubleValue (0.001),
+                   MakeDoubleAccessor (&SiftRouting::SetBloomFalsePositiveRate,
+                                       &SiftRouting::GetBloomFalsePositiveRate),
+                   MakeDoubleChecker<double> (1e-9, 0.5))
+    .AddTraceSource ("Tx", "Send SIFT packet, with the header of a packet this node is the source of.",
                      MakeTraceSourceAccessor (&SiftRouting::m_txPacketTrace),
 					 "ns3::SiftRouting::TxTracedValueCallback")
     .AddTraceSource ("Drop", "Drop SIFT packet",
                      MakeTraceSourceAccessor (&SiftRouting::m_dropTrace),
 					 "ns3::SiftRouting::DropTracedValueCallback")
+    .AddTraceSource ("DropReason", "Drop SIFT packet, with the reason of the drop. Unlike Drop, "
+                     "it also reports the packets filtered by the relays outside the corridor.",
+                     MakeTraceSourceAccessor (&SiftRouting::m_dropReasonTrace),
+                     "ns3::sift::SiftRouting::DropReasonTracedCallback")
+    .AddTraceSource ("SuspectedFalsePositives",
+                     "Number of Bloom filter matches for packets that cannot have been seen before.",
+                     MakeTraceSourceAccessor (&SiftRouting::m_suspectedFalsePositives),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("BloomEarlyRotations",
+                     "Number of Bloom filter generations retired before half the DuplicateLifetime "
+                     "because they held BloomCapacity packets. Each one shortens the time packets "
+                     "are remembered.",
+                     MakeTraceSourceAccessor (&SiftRouting::m_bloomEarlyRotations),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("BeaconTx", "Send a position beacon.",
+                     MakeTraceSourceAccessor (&SiftRouting::m_beaconTxTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("BeaconRx", "Receive a position beacon.",
+                     MakeTraceSourceAccessor (&SiftRouting::m_beaconRxTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("SuppressedBeacons",
+                     "Number of position beacons not sent because the previous one was still accurate.",
+                     MakeTraceSourceAccessor (&SiftRouting::m_suppressedBeacons),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("HopLimitDrops",
+                     "Number of packets not forwarded because their TTL ran out, each counted once "
+                     "however many copies of it are heard.",
+                     MakeTraceSourceAccessor (&SiftRouting::m_hopLimitDrops),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("TimerCollision",
+                     "Forward a SIFT packet at about the same time as another relay, whose copy "
+                     "is heard within CollisionWindow.",
+                     MakeTraceSourceAccessor (&SiftRouting::m_timerCollisionTrace),
+                     "ns3::Packet::TracedCallback")
   ;
   return tid;
 }
 
 SiftRouting::SiftRouting ()
-  : m_seqNo (0)
+  : m_suspectedFalsePositives (0),
+    m_bloomEarlyRotations (0),
+    m_suppressedBeacons (0),
+    m_hopLimitDrops (0),
+    m_seqNo (0),
+    m_duplicateDetection (DUPLICATE_CACHE),
+    m_locationService (ORACLE_LOCATION),
+    m_beaconSent (false),
+    m_compactHeader (false),
+    m_delayPolicy (RATIO_DELAY),
+    m_alpha (0.01),
+    m_transmissionTime (MicroSeconds (47)),
+    m_referenceNeighbors (8),
+    m_maxJitter (Seconds (0)),
+    m_collisionWindow (MilliSeconds (2)),
+    m_densityMinScale (0.25),
+    m_densityMaxScale (4),
+    m_densityEstimate (GEO_DENSITY),
+    m_densityWindow (Seconds (1))
 {
   NS_LOG_FUNCTION (this);
   m_uniformRandomVariable = CreateObject<UniformRandomVariable> ();
@@ -172,6 +395,11 @@ void SiftRouting::Start ()
 {
   NS_LOG_FUNCTION (this << "Start SIFT Routing protocol");
 
+  if (m_delayPolicy == DENSITY_DELAY && m_densityEstimate == GEO_DENSITY && IsOverhearingNeighbors ())
+    {
+      NS_LOG_WARN ("The geographic set is not refreshed, neighbors are counted from overheard frames");
+    }
+
   if (m_mainAddress == Ipv4Address ())
     {
 
@@ -211,13 +439,27 @@ void SiftRouting::Start ()
             }
         }
     }
+
+  if (m_locationService == BEACON_LOCATION)
+    {
+      // Spread the first beacons of the nodes over one interval
+      if (!m_beaconEvent.IsRunning ())
+        {
+          m_beaconEvent = Simulator::Schedule (Seconds (m_uniformRandomVariable->GetValue (0, m_beaconInterval.GetSeconds ())),
+                                               &SiftRouting::SendBeacon, this);
+        }
+    }
+  else if (m_geoRefreshInterval.IsStrictlyPositive () && !m_geoRefreshEvent.IsRunning ())
+    {
+      m_geoRefreshEvent = Simulator::ScheduleNow (&SiftRouting::RefreshGeographicSet, this);
+    }
 }
 
 void
 SiftRouting::AddNode (Ptr<Node> node)
 {
   NS_LOG_FUNCTION (this);
-  m_nodePtrs.push_back (node);
+  GetPositionOracle ()->AddNode (node);
   NS_LOG_INFO (node << "in AddNode");
 }
 
@@ -225,14 +467,42 @@ uint32_t
 SiftRouting::GetNodesSize (void)
 {
   NS_LOG_FUNCTION  (this);
-  NS_LOG_DEBUG ("m_nodePtrs.size (): " << m_nodePtrs.size ());
-  return m_nodePtrs.size ();
+  return GetPositionOracle ()->GetNNodes ();
+}
+
+void
+SiftRouting::SetPositionOracle (Ptr<SiftPositionOracle> oracle)
+{
+  NS_LOG_FUNCTION (this << oracle);
+  m_oracle = oracle;
+}
+
+Ptr<SiftPositionOracle>
+SiftRouting::GetPositionOracle (void)
+{
+  if (m_oracle == 0)
+    {
+      m_oracle = CreateObject<SiftPositionOracle> ();
+    }
+  return m_oracle;
 }
 
 void
 SiftRouting::DoDispose (void)
 {
   NS_LOG_FUNCTION  (this);
+  for (ContentionTimerTable::iterator it = m_timer.begin (); it != m_timer.end (); ++it)
+    {
+      it->second.Cancel ();
+    }
+  m_timer.clear ();
+  m_recentForwards.clear ();
+  m_geoRefreshEvent.Cancel ();
+  m_beaconEvent.Cancel ();
+  m_trajectoryCache.clear ();
+  m_overheardNeighbors.clear ();
+  m_registry = 0;
+  m_oracle = 0;
   m_node = 0;
   IpL4Protocol::DoDispose ();
 }
@@ -255,18 +525,136 @@ Ptr<Node>
 SiftRouting::GetNodeWithAddress (Ipv4Address ipv4Address)
 {
   NS_LOG_FUNCTION (this << ipv4Address);
-  int32_t nNodes = NodeList::GetNNodes ();
-  for (int32_t i = 0; i < nNodes; ++i)
+  return GetNodeRegistry ()->GetNode (ipv4Address);
+}
+
+template <class Policy>
+Time
+SiftRouting::GetContentionDelay (SiftDelayContext &context, double x, double y)
+{
+  context.neighbors = 0;
+  context.referenceNeighbors = m_referenceNeighbors;
+  context.minScale = m_densityMinScale;
+  context.maxScale = m_densityMaxScale;
+  if (Policy::NEEDS_NEIGHBORS && IsOverhearingNeighbors ())
+    {
+      context.neighbors = CountOverheardNeighbors ();
+    }
+  else if (Policy::NEEDS_NEIGHBORS)
+    {
+      std::vector<Ipv4Address> nodes;
+      m_state.GetNodesInRadius (x, y, context.range, nodes);
+      for (uint32_t i = 0; i < nodes.size (); ++i)
+        {
+          if (nodes[i] != m_mainAddress)
+            {
+              context.neighbors++;
+            }
+        }
+    }
+  return Seconds (Policy ().GetDelay (context, m_transmissionTime.GetSeconds (), m_alpha)) + GetJitter ();
+}
+
+Time
+SiftRouting::GetJitter (void)
+{
+  if (!m_maxJitter.IsStrictlyPositive ())
+    {
+      return Seconds (0);
+    }
+  return Seconds (m_uniformRandomVariable->GetValue (0, m_maxJitter.GetSeconds ()));
+}
+
+Time
+SiftRouting::GetContentionDelay (SiftDelayContext &context, double x, double y)
+{
+  switch (m_delayPolicy)
+    {
+    case PROGRESS_DELAY:
+      return GetContentionDelay<ProgressDelay> (context, x, y);
+    case DISTANCE_DELAY:
+      return GetContentionDelay<DistanceOnlyDelay> (context, x, y);
+    case DENSITY_DELAY:
+      return GetContentionDelay<DensityAdaptiveDelay> (context, x, y);
+    case RATIO_DELAY:
+    default:
+      return GetContentionDelay<TrajectoryRatioDelay> (context, x, y);
+    }
+}
+
+bool
+SiftRouting::IsOverhearingNeighbors (void) const
+{
+  if (m_delayPolicy != DENSITY_DELAY)
     {
-      Ptr<Node> node = NodeList::GetNode (i);
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      int32_t ifIndex = ipv4->GetInterfaceForAddress (ipv4Address);
-      if (ifIndex != -1)
+      return false;
+    }
+  // Without beacons or a periodic refresh the geographic set only holds this node, and the
+  // Geo estimate would always count 0 neighbors
+  return m_densityEstimate == OVERHEARD_DENSITY
+         || (m_locationService == ORACLE_LOCATION && !m_geoRefreshInterval.IsStrictlyPositive ());
+}
+
+void
+SiftRouting::RecordOverheardNeighbor (Ipv4Address sender)
+{
+  NS_LOG_FUNCTION (this << sender);
+  m_overheardNeighbors[sender] = Simulator::Now ();
+}
+
+uint32_t
+SiftRouting::CountOverheardNeighbors (void)
+{
+  Time oldest = Simulator::Now () - m_densityWindow;
+  for (OverheardNeighbors::iterator i = m_overheardNeighbors.begin (); i != m_overheardNeighbors.end (); )
+    {
+      if (i->second < oldest)
+        {
+          i = m_overheardNeighbors.erase (i);
+        }
+      else
         {
-          return node;
+          ++i;
         }
     }
-  return 0;
+  return m_overheardNeighbors.size ();
+}
+
+void
+SiftRouting::DropPacket (Ptr<const Packet> packet, DropReason reason)
+{
+  NS_LOG_FUNCTION (this << packet << reason);
+  // Every relay outside the corridor filters the packet by design; Drop keeps to real losses
+  if (reason != DROP_OFF_CORRIDOR)
+    {
+      m_dropTrace (packet);
+    }
+  m_dropReasonTrace (packet, reason);
+}
+
+void
+SiftRouting::SetWaypointCallback (WaypointCallback callback)
+{
+  NS_LOG_FUNCTION (this);
+  m_waypointCallback = callback;
+  m_trajectoryCache.clear ();
+}
+
+void
+SiftRouting::SetNodeRegistry (Ptr<SiftNodeRegistry> registry)
+{
+  NS_LOG_FUNCTION (this << registry);
+  m_registry = registry;
+}
+
+Ptr<SiftNodeRegistry>
+SiftRouting::GetNodeRegistry (void)
+{
+  if (m_registry == 0)
+    {
+      m_registry = CreateObject<SiftNodeRegistry> ();
+    }
+  return m_registry;
 }
 
 void SiftRouting::PrintVector (std::vector<Ipv4Address>& vec)
@@ -354,50 +742,207 @@ SiftRouting::Send (Ptr<Packet> packet,
       NS_LOG_INFO ("Protocol number if protocol<>1: " << (uint32_t)protocol);
       Ptr<Packet> cleanP = packet->Copy ();
       SiftHeader siftHeader;
-      siftHeader.SetNextHeader (protocol);
-      siftHeader.SetMessageType (47);
-      siftHeader.SetSourceAddress (source);
-      siftHeader.SetDestAddress (destination);
-
-      //  take this node's location
-      Ptr<MobilityModel> mobility = GetObject<Node> ()->GetObject<MobilityModel> ();
-      Ptr<Node> destNode = GetNodeWithAddress (destination);
-      Ptr<Node> sourceNode = GetNodeWithAddress (source);
-      Ptr<MobilityModel> destMobility = destNode->GetObject<MobilityModel> ();
-      Ptr<MobilityModel> sourceMobility = sourceNode->GetObject<MobilityModel> ();
-      int32_t x_ = sourceMobility->GetPosition ().x;
-      int32_t y_ = sourceMobility->GetPosition ().y;
-      int32_t x = mobility->GetPosition ().x;
-      int32_t y = mobility->GetPosition ().y;
-      int32_t x1 = destMobility->GetPosition ().x;
-      int32_t y1 = destMobility->GetPosition ().y;
-      siftHeader.SetSourceXLoc ((int32_t)x_);
-      siftHeader.SetSourceYLoc ((int32_t)y_);
-      siftHeader.SetLastSourceXLoc ((int32_t)x);
-      siftHeader.SetLastSourceYLoc ((int32_t)y);
-      siftHeader.SetDestXLoc ((int32_t)x1);
-      siftHeader.SetDestYLoc ((int32_t)y1);
+      if (!GetTrajectoryHeader (source, destination, protocol, siftHeader))
+        {
+          NS_LOG_DEBUG ("No known position for " << destination << ", dropping the packet");
+          DropPacket (packet, DROP_NO_POSITION);
+          return;
+        }
+      // Only the sequence number and the TTL change from one packet to the next
       siftHeader.SetHeaderSeqNo (GetSeqNo ());
       siftHeader.SetHeaderTTL (TTL);
       NS_LOG_DEBUG (this << "Node positions in Send module of node: " << this->GetNode ()->GetId () <<
                     " (source X, Source Y)= ("
-                         << x_ << ", " << y_ << ") (Current X, Current Y)= ("
-                         << x << ", " << y << ") (Destination X, Destination Y)= ("
-                         << x1 << ", " << y1 << ")");
+                         << siftHeader.GetSourceXLoc () << ", " << siftHeader.GetSourceYLoc ()
+                         << ") (Current X, Current Y)= ("
+                         << siftHeader.GetLastSourceXLoc () << ", " << siftHeader.GetLastSourceYLoc ()
+                         << ") (Destination X, Destination Y)= ("
+                         << siftHeader.GetDestXLoc () << ", " << siftHeader.GetDestYLoc () << ")");
 
 
 
       cleanP->AddHeader (siftHeader);
       Ptr<Packet> mtP = cleanP->Copy ();
 
-      // Save a copy of packet in the buffer to check duplicate packets
-      m_buffer.insert (std::pair<Ptr<Packet>,Time> (mtP,Simulator::Now ()));
+      // Remember the packet so that its rebroadcasts are detected as duplicates
+      SiftPacketKey key;
+      key.source = source;
+      key.destination = destination;
+      key.seqNo = siftHeader.GetHeaderSeqNo ();
+      RecordPacket (key);
+      m_txPacketTrace (siftHeader);
       // Send the packet out with header
       SendPacket (mtP, source, m_broadcast, protocol);
 
     }
 }
 
+bool
+SiftRouting::GetTrajectoryHeader (Ipv4Address source, Ipv4Address destination, uint8_t protocol,
+                                  SiftHeader &header)
+{
+  NS_LOG_FUNCTION (this << source << destination << (uint32_t)protocol);
+  if (!m_trajectoryCacheLifetime.IsStrictlyPositive ())
+    {
+      Vector velocity;
+      return BuildTrajectoryHeader (source, destination, protocol, header, velocity);
+    }
+  Ptr<MobilityModel> mobility = GetObject<Node> ()->GetObject<MobilityModel> ();
+  Vector position = mobility->GetPosition ();
+  Time now = Simulator::Now ();
+  double limit2 = m_trajectoryCacheDistance * m_trajectoryCacheDistance;
+  TrajectoryCache::iterator it = m_trajectoryCache.find (destination);
+  if (it != m_trajectoryCache.end ())
+    {
+      const SiftHeader &cached = it->second.header;
+      double dx = position.x - cached.GetLastSourceXLoc ();
+      double dy = position.y - cached.GetLastSourceYLoc ();
+      // Where the destination is now, from the newest beacon or, with the oracle, extrapolated
+      // from the position and velocity the entry was built with. A change of velocity is only
+      // seen through the oracle once the entry is rebuilt.
+      double destX = cached.GetDestXLoc () + it->second.destVelocity.x * (now - it->second.created).GetSeconds ();
+      double destY = cached.GetDestYLoc () + it->second.destVelocity.y * (now - it->second.created).GetSeconds ();
+      bool known = m_locationService != BEACON_LOCATION
+        || m_state.PredictPosition (destination, now, m_locationTimeout, destX, destY);
+      double ex = destX - cached.GetDestXLoc ();
+      double ey = destY - cached.GetDestYLoc ();
+      if (now - it->second.created < m_trajectoryCacheLifetime
+          && dx * dx + dy * dy <= limit2
+          && known && ex * ex + ey * ey <= limit2
+          && cached.GetSourceAddress () == source
+          && cached.GetNextHeader () == protocol)
+        {
+          header = cached;
+          return true;
+        }
+      m_trajectoryCache.erase (it);
+    }
+  if (now - m_trajectoryCachePurge >= m_trajectoryCacheLifetime)
+    {
+      // Entries of destinations no longer sent to are dropped once per lifetime
+      for (TrajectoryCache::iterator entry = m_trajectoryCache.begin (); entry != m_trajectoryCache.end (); )
+        {
+          if (now - entry->second.created >= m_trajectoryCacheLifetime)
+            {
+              entry = m_trajectoryCache.erase (entry);
+            }
+          else
+            {
+              ++entry;
+            }
+        }
+      m_trajectoryCachePurge = now;
+    }
+  TrajectoryCacheEntry entry;
+  if (!BuildTrajectoryHeader (source, destination, protocol, header, entry.destVelocity))
+    {
+      return false;
+    }
+  entry.header = header;
+  entry.created = now;
+  m_trajectoryCache.insert (std::make_pair (destination, entry));
+  return true;
+}
+
+uint32_t
+SiftRouting::GetNCachedTrajectories (void) const
+{
+  return m_trajectoryCache.size ();
+}
+
+bool
+SiftRouting::BuildTrajectoryHeader (Ipv4Address source, Ipv4Address destination, uint8_t protocol,
+                                    SiftHeader &header, Vector &destVelocity)
+{
+  NS_LOG_FUNCTION (this << source << destination << (uint32_t)protocol);
+  header.SetNextHeader (protocol);
+  header.SetMessageType (47);
+  header.SetSourceAddress (source);
+  header.SetDestAddress (destination);
+  header.SetCompact (m_compactHeader);
+
+  //  take this node's location
+  Ptr<MobilityModel> mobility = GetObject<Node> ()->GetObject<MobilityModel> ();
+  Ptr<Node> sourceNode = GetNodeWithAddress (source);
+  Ptr<MobilityModel> sourceMobility = sourceNode->GetObject<MobilityModel> ();
+  int32_t x_ = sourceMobility->GetPosition ().x;
+  int32_t y_ = sourceMobility->GetPosition ().y;
+  int32_t x = mobility->GetPosition ().x;
+  int32_t y = mobility->GetPosition ().y;
+
+  double destX = 0;
+  double destY = 0;
+  bool predicted = false;
+  if (m_locationService == BEACON_LOCATION)
+    {
+      // Only the beacons tell where the destination is
+      predicted = m_state.PredictPosition (destination, Simulator::Now (), m_locationTimeout, destX, destY);
+      if (!predicted)
+        {
+          return false;
+        }
+    }
+  else if (m_predictionStaleness.IsStrictlyPositive ())
+    {
+      // Predict where the destination is from its last known position and velocity, and only
+      // read its mobility model when that record is missing or older than PredictionStaleness
+      predicted = m_state.PredictPosition (destination, Simulator::Now (), m_predictionStaleness, destX, destY);
+    }
+  destVelocity = Vector ();
+  if (predicted)
+    {
+      GeographicTuple *tuple = m_state.FindGeographicTuple (destination);
+      destVelocity = Vector (tuple->xvelocity, tuple->yvelocity, 0);
+    }
+  else
+    {
+      Ptr<Node> destNode = GetNodeWithAddress (destination);
+      Ptr<MobilityModel> destMobility = destNode->GetObject<MobilityModel> ();
+      destX = destMobility->GetPosition ().x;
+      destY = destMobility->GetPosition ().y;
+      destVelocity = destMobility->GetVelocity ();
+      // The record is what later predictions extrapolate from
+      if (m_predictionStaleness.IsStrictlyPositive ())
+        {
+          UpdateGeographicTuple (destNode);
+        }
+    }
+  int32_t x1 = destX;
+  int32_t y1 = destY;
+  header.SetSourceXLoc ((int32_t)x_);
+  header.SetSourceYLoc ((int32_t)y_);
+  header.SetLastSourceXLoc ((int32_t)x);
+  header.SetLastSourceYLoc ((int32_t)y);
+  header.SetDestXLoc ((int32_t)x1);
+  header.SetDestYLoc ((int32_t)y1);
+  if (!m_waypointCallback.IsNull ())
+    {
+      std::vector<SiftWaypoint> waypoints = m_waypointCallback (Vector (x_, y_, 0), Vector (x1, y1, 0));
+      if (!waypoints.empty ())
+        {
+          // Drop the waypoints on the line between their neighbors, the source and the
+          // destination included, so that each one costs header bytes only where the trajectory turns
+          SiftWaypoint start = { x_, y_ };
+          SiftWaypoint end = { x1, y1 };
+          waypoints.insert (waypoints.begin (), start);
+          waypoints.push_back (end);
+          SimplifyTrajectory (waypoints);
+          waypoints.erase (waypoints.end () - 1);
+          waypoints.erase (waypoints.begin ());
+        }
+      if (waypoints.size () > SiftHeader::MAX_WAYPOINTS)
+        {
+          // Cutting the list would send the packet straight from the last waypoint kept to the destination
+          NS_LOG_WARN ("Trajectory from (" << x_ << ", " << y_ << ") to (" << x1 << ", " << y1 << ") has "
+                                           << waypoints.size () << " waypoints, more than " << (uint32_t)SiftHeader::MAX_WAYPOINTS
+                                           << ", sending the packet along the straight line instead");
+          waypoints.clear ();
+        }
+      header.SetWaypoints (waypoints);
+    }
+  return true;
+}
+
 void
 SiftRouting::SendPacket (Ptr<Packet> packet, Ipv4Address source, Ipv4Address nextHop, uint8_t protocol)
 {
@@ -439,105 +984,69 @@ SiftRouting::ForwardPacket (Ptr<Packet> packet,
   NS_ASSERT_MSG (!m_downTarget.IsNull (), "Error, SiftRouting cannot send downward");
 
 
-  // Forward the packet here, we will not use any coding and multipath here
-  SendPacket (packet, source, m_broadcast, protocol);
+  // Forward the packet here, we will not use any coding and multipath here. The SIFT header
+  // carries the source; the IP source is this relay, so receivers can tell senders apart
+  SendPacket (packet, m_mainAddress, m_broadcast, protocol);
 }
 
 void
-SiftRouting::ScheduleTimer (Ptr<Packet> packet, Time delay, Ipv4Address source, uint8_t protocol)
+SiftRouting::ScheduleTimer (const SiftPacketKey &key, Ptr<Packet> packet, Time delay, Ipv4Address source, uint8_t protocol)
 {
-  NS_LOG_FUNCTION ("SiftRouting::ScheduleTimer" << this << packet << delay << source << (uint32_t)protocol);
-  NS_LOG_INFO (this << packet << delay << source << protocol);
-
+  NS_LOG_FUNCTION ("SiftRouting::ScheduleTimer" << this << key << packet << delay << source << (uint32_t)protocol);
 
-
-  SiftHeader tempSift, timerSift;
-  packet->PeekHeader (tempSift);
-  bool matchFound = false;
-  if (m_timer.size () == 0)     // Timer buffer is empty. This is the first packet being scheduled
+  ContentionTimerTable::iterator it = m_timer.find (key);
+  if (it != m_timer.end ())
     {
-      NS_LOG_DEBUG ("In ScheduleTimer of node (" << this->GetNode ()->GetId () << ") with IP address: "
-                                                 << this->GetIPfromID (this->GetNode ()->GetId ())
-                                                 << "Timer buffer is empty. New packet is scheduling. \nThis is the packet: \n"
-                                                 << " Current time: " << Seconds (Simulator::Now ()) );
-
-      Timer timer (Timer::CANCEL_ON_DESTROY);
-      m_timer[packet] = timer;
+      NS_LOG_DEBUG ("\nMatch was found in timer buffer (duplicate packet). The packet is unscheduling and erasing\n");
+      // A duplicate packet was found for a new arrival packet.
+      it->second.Cancel ();
+      m_timer.erase (it);
+      return;
     }
-  else                                          // Timer buffer has some content. Duplicate packets are checking and if there is no duplication, the packet is scheduled.
-    {
-      for (std::map<Ptr<Packet>,Timer >::iterator it = m_timer.begin (); it != m_timer.end (); ++it)
-        {
-          (it->first)->PeekHeader (timerSift);
-          NS_LOG_DEBUG (*(it->first) << " State in ScheduleTimer: " << (it->second).GetState () << " Current Time (Sec): " << Seconds (Simulator::Now ()) );
-
-          if (timerSift.GetSourceAddress () == tempSift.GetSourceAddress ()
-              && timerSift.GetDestAddress () == tempSift.GetDestAddress ()
-              && timerSift.GetHeaderSeqNo () == tempSift.GetHeaderSeqNo ()
-              && matchFound == false)           // Checking duplicate packets
-            {
-              NS_LOG_DEBUG ("\nMatch was found in timer buffer (duplicate packet). The packet is unscheduling and erasing\n");
 
-              // A duplicate packet was found for a new arrival packet.
-              (it->second).Cancel ();
-              //sum_timer.erase(it);
-              matchFound = true;
-
-            }
-          if ((it->second).GetState () == Timer::EXPIRED)           //Expired event
-            {
-              NS_LOG_DEBUG ("One expired event was removed at node (" << this->GetNode ()->GetId () << ") with IP address: "
-                                                                      << this->GetIPfromID (this->GetNode ()->GetId ())
-                                                                      << "Current time (sec): " << Seconds (Simulator::Now ()));
-
-              m_timer.erase (it);
-            }
+  NS_LOG_DEBUG ("No duplication was found. New packet is scheduling ....Current time: " << Seconds (Simulator::Now ()));
+  // When the timer expires, the packet is forwarded and its entry is reclaimed
+  m_timer[key] = Simulator::Schedule (delay, &SiftRouting::ContentionTimerExpire, this,
+                                      key, packet, source, protocol);
+}
 
+void
+SiftRouting::ContentionTimerExpire (SiftPacketKey key, Ptr<Packet> packet, Ipv4Address source, uint8_t protocol)
+{
+  NS_LOG_FUNCTION (this << key);
+  m_timer.erase (key);
+  // Remember the forward while the copy of a relay whose timer expired at about the same
+  // time can still arrive. Both frames wait for the channel and take their airtime after
+  // the timers fire, so the window is set from the MAC, not from TransmissionTime
+  Time oldest = Simulator::Now () - m_collisionWindow;
+  for (ForwardTimeTable::iterator it = m_recentForwards.begin (); it != m_recentForwards.end (); )
+    {
+      if (it->second < oldest)
+        {
+          it = m_recentForwards.erase (it);
         }
-      if (matchFound == false)
+      else
         {
-          NS_LOG_DEBUG ("No duplication was found. New packet is scheduling ....Current time: " << Seconds (Simulator::Now ()));
-
-          Timer timer (Timer::CANCEL_ON_DESTROY);
-          m_timer[packet] = timer;
+          ++it;
         }
     }
-
-
-  // When the timer expires, it will call this function here, which is send for this case
-  m_timer[packet].SetFunction (&SiftRouting::ForwardPacket, this);
-  m_timer[packet].Remove ();
-  m_timer[packet].SetArguments (packet, source, protocol);
-  m_timer[packet].Schedule (delay);
+  m_recentForwards[key] = Simulator::Now ();
+  ForwardPacket (packet, source, protocol);
 }
 
 void 
-SiftRouting::CancelTimer (Ptr<Packet> p)
+SiftRouting::CancelTimer (const SiftPacketKey &key)
 {
-  NS_LOG_FUNCTION ("SiftRouting::CancelTimer");
-  NS_LOG_INFO (this << p );
+  NS_LOG_FUNCTION ("SiftRouting::CancelTimer" << key);
 
   // We erase the timer if we have received it before
-  NS_LOG_DEBUG ("\nTimer Content: \n");
-  SiftHeader tempSift, timerSift;
-  p->PeekHeader (tempSift);
-  for (std::map<Ptr<Packet>,Timer >::iterator it = m_timer.begin (); it != m_timer.end (); ++it)
+  ContentionTimerTable::iterator it = m_timer.find (key);
+  if (it != m_timer.end ())
     {
-      (it->first)->PeekHeader (timerSift);
-      NS_LOG_DEBUG (*(it->first) << " State: " << (it->second).GetState () << " Current Time: " << Simulator::Now ());
-
-      if (timerSift.GetSourceAddress () == tempSift.GetSourceAddress ()
-          && timerSift.GetDestAddress () == tempSift.GetDestAddress ()
-          && timerSift.GetHeaderSeqNo () == tempSift.GetHeaderSeqNo ())
-        {
-          NS_LOG_DEBUG ("\nMatch was found in timer buffer (Cancel Timer). The record is deleting \n");
-          (it->second).Cancel ();
-          m_timer.erase (it);
-          break;
-        }
-
+      NS_LOG_DEBUG ("\nMatch was found in timer buffer (Cancel Timer). The record is deleting \n");
+      it->second.Cancel ();
+      m_timer.erase (it);
     }
-
 }
 
 enum IpL4Protocol::RxStatus
@@ -553,6 +1062,49 @@ SiftRouting::Receive (Ptr<Packet> p,
   m_node = GetNode ();                        // Get the node
   NS_LOG_FUNCTION ("\n\nEntering Receive module of node: " << m_node->GetId () << " with IP address: " << this->GetIPfromID (this->GetNode ()->GetId ()));
 
+  if (SiftBeaconHeader::IsBeacon (p))
+    {
+      return ReceiveBeacon (p->Copy (), ip.GetSource ());
+    }
+
+  // Reject duplicates from the key alone, before the packet is copied and its header parsed
+  SiftKeyHeader keyHeader;
+  p->PeekHeader (keyHeader);
+  if (keyHeader.GetDestAddress () == Ipv4Address::GetZero ())
+    {
+      NS_LOG_DEBUG ("A 0.0.0.0 received in Receive module at time: " << Seconds (Simulator::Now ())
+                                                                     << "\nReturning from the Receive module with code RX_ENDPOINT_UNREACH\n");
+
+      return RX_ENDPOINT_UNREACH;
+    }
+  SiftPacketKey key;
+  key.source = keyHeader.GetSourceAddress ();
+  key.destination = keyHeader.GetDestAddress ();
+  key.seqNo = keyHeader.GetHeaderSeqNo ();
+  NS_LOG_DEBUG ("\nChecking Receive Buffer in node: " << this->GetIPfromID (this->GetNode ()->GetId ()) << " ... \n");
+  NS_LOG_DEBUG ("\n Comparing Source Address: " << key.source << " Destination Address: " << key.destination << " Seq No: " << key.seqNo << " with the content of the buffer ... \n");
+  if (IsDuplicate (key))
+    {
+      NS_LOG_INFO (" Duplicate packet received " << m_node->GetId () << p);
+      ForwardTimeTable::iterator forward = m_recentForwards.find (key);
+      if (forward != m_recentForwards.end ())
+        {
+          if (Simulator::Now () - forward->second <= m_collisionWindow)
+            {
+              NS_LOG_DEBUG ("Another relay forwarded the packet at about the same time as node " << m_node->GetId ());
+              m_timerCollisionTrace (p);
+            }
+          m_recentForwards.erase (forward);
+        }
+      if (IsOverhearingNeighbors ())
+        {
+          // Rebroadcasts are most of what a relay hears, so their senders are counted too
+          RecordOverheardNeighbor (ip.GetSource ());
+        }
+      CancelTimer (key);
+      return RX_ENDPOINT_UNREACH;
+    }
+
   Ptr<Packet> packet = p->Copy ();            // Save a copy of the received packet
 
 
@@ -569,6 +1121,10 @@ SiftRouting::Receive (Ptr<Packet> p,
   int32_t lastsourceYLoc = siftHeader.GetLastSourceYLoc ();
   int32_t destXLoc = siftHeader.GetDestXLoc ();
   int32_t destYLoc = siftHeader.GetDestYLoc ();
+  if (IsOverhearingNeighbors ())
+    {
+      RecordOverheardNeighbor (ip.GetSource ());
+    }
 
   uint8_t segmentsLeft = siftHeader.GetSegmentsLeft ();
   uint16_t headerSeqNo = siftHeader.GetHeaderSeqNo ();
@@ -583,13 +1139,6 @@ SiftRouting::Receive (Ptr<Packet> p,
 
 
 
-  if (destAddress.IsEqual ("0.0.0.0"))
-    {
-      NS_LOG_DEBUG ("A 0.0.0.0 received in Receive module at time: " << Seconds (Simulator::Now ())
-                                                                     << "\nReturning from the Receive module with code RX_ENDPOINT_UNREACH\n");
-
-      return RX_ENDPOINT_UNREACH;
-    }
   if ((int)GetObject<Node> ()->GetObject<MobilityModel> ()->GetPosition ().x == sourceXLoc
       && (int)GetObject<Node> ()->GetObject<MobilityModel> ()->GetPosition ().y == sourceYLoc  )
     {
@@ -598,47 +1147,46 @@ SiftRouting::Receive (Ptr<Packet> p,
     }
 
   NS_LOG_DEBUG ("The segments left in source route header " << (uint32_t)segmentsLeft);
-  Ptr<Packet> tempPacket;
-  SiftHeader tempSift;
-  bool duplicate = false;
-  NS_LOG_DEBUG ("\nChecking Receive Buffer in node: " << this->GetIPfromID (this->GetNode ()->GetId ()) << " ... \n");
-
 
-  NS_LOG_DEBUG ("\n Comparing Source Address: " << sourceAddress << " Destination Address: " << destAddress << " Seq No: " << headerSeqNo << " with the content of the buffer ... \n");
-
-  for (std::map<Ptr<Packet>,Time >::iterator it = m_buffer.begin (); it != m_buffer.end (); ++it)
+  // The trajectory is the segment the packet is on. Once this node is past the end of a
+  // segment towards a waypoint, the packet moves on to the next segment.
+  Vector position = GetObject<Node> ()->GetObject<MobilityModel> ()->GetPosition ();
+  int32_t currentXLoc = position.x;
+  int32_t currentYLoc = position.y;
+  int32_t startXLoc, startYLoc, endXLoc, endYLoc;
+  siftHeader.GetActiveSegment (startXLoc, startYLoc, endXLoc, endYLoc);
+  double dCorridor = 0;
+  // The packet is recorded before any drop, so that its later copies are rejected by the
+  // peeked key and a dropped packet is reported and counted once
+  RecordPacket (key);
+  NS_LOG_DEBUG ("One packet was added to node " << this->GetIPfromID (this->GetNode ()->GetId ())
+                                                << "Current time: " << Seconds (Simulator::Now ()) << "\n");
+  if (m_mainAddress != destAddress)
     {
-      if (Simulator::Now () - it->second >= Seconds (3))
+      // The forwarded copy carries headerTTL - 1, which must not reach zero or wrap around
+      if (headerTTL <= 1)
         {
-          m_buffer.erase (it);
-          NS_LOG_DEBUG ("One expired packet was removed from buffer of node: " << this->GetIPfromID (this->GetNode ()->GetId ()));
-
+          NS_LOG_DEBUG ("TTL of the packet ran out at node " << m_node->GetId () << ", dropping the packet");
+          m_hopLimitDrops++;
+          DropPacket (p, DROP_TTL_EXPIRED);
+          return RX_ENDPOINT_UNREACH;
         }
-      else
+      while (segmentsLeft > 1 && segmentsLeft <= siftHeader.GetWaypoints ().size () + 1
+             && SegmentProgress (currentXLoc, currentYLoc, startXLoc, startYLoc, endXLoc, endYLoc) >= 1)
         {
-          tempPacket = it->first;
-          tempPacket->PeekHeader (tempSift);
-
-          if (tempSift.GetSourceAddress () == sourceAddress
-              && tempSift.GetDestAddress () == destAddress
-              && tempSift.GetHeaderSeqNo () == headerSeqNo)
-            {
-              NS_LOG_INFO (" Duplicate packet received " << m_node->GetId () << p);
-              CancelTimer (tempPacket);
-              duplicate = true;
-              return RX_ENDPOINT_UNREACH;
-            }
-
-
-        } // end of else (Simulator::Now()-it->second >= Seconds(2)
-    } // end of for
-
-  if (duplicate == false)
-    {
-      m_buffer.insert (std::pair<Ptr<Packet>,Time> (p,Simulator::Now ()));
-      NS_LOG_DEBUG ("One packet was added to node " << this->GetIPfromID (this->GetNode ()->GetId ())
-                                                    << "Current time: " << Seconds (Simulator::Now ()) << "\n");
-
+          siftHeader.SetSegmentsLeft (--segmentsLeft);
+          siftHeader.GetActiveSegment (startXLoc, startYLoc, endXLoc, endYLoc);
+        }
+      // A relay outside the corridor drops the packet before it takes a timer. The packet is
+      // already recorded, so the copies forwarded by the other relays are rejected from their
+      // key, without being parsed again. The destination always accepts it.
+      dCorridor = DistanceToSegment (currentXLoc, currentYLoc, startXLoc, startYLoc, endXLoc, endYLoc);
+      if (dCorridor > m_corridorWidth)
+        {
+          NS_LOG_DEBUG ("Node " << m_node->GetId () << " is " << dCorridor << " m from the trajectory, dropping the packet");
+          DropPacket (p, DROP_OFF_CORRIDOR);
+          return RX_ENDPOINT_UNREACH;
+        }
     }
 
   Ipv4Address zero;
@@ -742,16 +1290,14 @@ SiftRouting::Receive (Ptr<Packet> p,
   else   // This is not final destination, forward the packet to next hop
     {
 
-      GeographicTuple geoTuple;
       NS_LOG_INFO ("This is not the final destination, forward the packet to next hop");
-      siftHeader.SetSegmentsLeft (segmentsLeft - 1);  // decrement the segments left field
       siftHeader.SetNextHeader (protocol);
       siftHeader.SetMessageType (2);
       siftHeader.SetSourceAddress (sourceAddress);
       siftHeader.SetSourceXLoc (sourceXLoc);            // New code
       siftHeader.SetSourceYLoc (sourceYLoc);
-      siftHeader.SetLastSourceXLoc (GetObject<Node> ()->GetObject<MobilityModel> ()->GetPosition ().x);
-      siftHeader.SetLastSourceYLoc (GetObject<Node> ()->GetObject<MobilityModel> ()->GetPosition ().y);
+      siftHeader.SetLastSourceXLoc (currentXLoc);
+      siftHeader.SetLastSourceYLoc (currentYLoc);
       siftHeader.SetDestAddress (destAddress);
       siftHeader.SetDestXLoc (destXLoc);
       siftHeader.SetDestYLoc (destYLoc);                                // New code
@@ -763,129 +1309,50 @@ SiftRouting::Receive (Ptr<Packet> p,
                     ", This is not final destination for this packet in Receive module at time: " << Seconds (Simulator::Now ()) << "\n");
 
 
-      for (uint32_t nodeNum = 0; nodeNum < GetNodesSize (); nodeNum++)
-        {
-          //GeographicTuple geoTuple;
-          Ptr<Node> node = m_nodePtrs[nodeNum];
-          NS_ASSERT (node != 0);
-          geoTuple.nodeAddr = node->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
-          Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
-
-
-          Time now = Simulator::Now ();
-          geoTuple.nodeReceivedFrom = m_mainAddress;
-          geoTuple.recordedTime = now;
-          geoTuple.dataRecordedTime = now;
-          geoTuple.expireTime = Simulator::GetMaximumSimulationTime ();
-          geoTuple.xcoord = (int32_t) mobility->GetPosition ().x;
-          geoTuple.ycoord = (int32_t) mobility->GetPosition ().y;
-          geoTuple.zcoord = (int32_t) mobility->GetPosition ().z;
-          geoTuple.xvelocity = (uint16_t) mobility->GetVelocity ().x;
-          geoTuple.yvelocity = (uint16_t) mobility->GetVelocity ().y;
-          geoTuple.zvelocity = (uint16_t) mobility->GetVelocity ().z;
-          bool needTriggerUpdate = false;
-          m_state.InsertGeographicTuple (geoTuple, needTriggerUpdate);
-          NS_LOG_INFO ("Current Location details: " << geoTuple.nodeAddr
-                                                    << " X:" << (int)geoTuple.xcoord
-                                                    << " Y:" << (int)geoTuple.ycoord
-                                                    << " Z:" << (int)geoTuple.zcoord
-                                                    << " Vx:" << (int)geoTuple.xvelocity
-                                                    << " Vy:" << (int)geoTuple.yvelocity
-                                                    << " Vz:" << (int)geoTuple.zvelocity);
-          NS_LOG_INFO ("Sift Header details: "
-                       << "\n\t Source geographic location (x,y): (" << sourceXLoc << ", " << sourceYLoc << ")"
-                       << "\n\t Source IP Address: " << sourceAddress
-                       << "\n\t Current geographic location (x,y): (" << (int) mobility->GetPosition ().x << ", " << (int) mobility->GetPosition ().y << ")"
-                       << "\n\t Current IP Address: " << m_mainAddress
-                       << "\n\t Destination geographic location (x,y): (" << destXLoc << ", " << destYLoc << ")"
-                       << "\n\t Destination IP Address: " << destAddress);
-
-        }
-
-
-      // calculation of dist.
-      double currentX = siftHeader.GetLastSourceXLoc ();
-      double currentY = siftHeader.GetLastSourceYLoc ();
-      double slope = 0; // slope= (destYLoc-sourceYLoc)/(destXLoc-sourceXLoc); //y=mx+b
-      double Y = (destYLoc - sourceYLoc);
-      double X = (destXLoc - sourceXLoc);
-      double dTrajectory = 0.0; // Distance of the current node from the trajectory
-      double dLastSource = 0.0; // Distance of the current node from the last sender
-      double b = 0.0;
-      double xIntersect = 0.0;
-      double yIntersect = 0.0;
-      double delayTimer = (double)TRANSMISSION_TIME;
-
-      if (Y == 0)
-        {
-          slope = 0;
-          b = sourceYLoc - (slope * sourceXLoc);
+      // Only the position of this relay is needed here; the rest of the
+      // geographic set is refreshed on its own schedule, see GeoRefreshInterval
+      UpdateGeographicTuple (m_node);
+      NS_LOG_INFO ("Sift Header details: "
+                   << "\n\t Source geographic location (x,y): (" << sourceXLoc << ", " << sourceYLoc << ")"
+                   << "\n\t Source IP Address: " << sourceAddress
+                   << "\n\t Current IP Address: " << m_mainAddress
+                   << "\n\t Destination geographic location (x,y): (" << destXLoc << ", " << destYLoc << ")"
+                   << "\n\t Destination IP Address: " << destAddress);
 
-          xIntersect = (currentX + slope * currentY - slope * b) / (pow (slope,2) + 1);
-          yIntersect = slope * xIntersect + b;
-          dTrajectory = sqrt (pow ((xIntersect - currentX),2) + pow ((yIntersect - currentY),2));
-          dLastSource = sqrt (pow ((lastsourceXLoc - currentX),2) +
-                              pow ((lastsourceYLoc - currentY),2));
 
+      // Distance of this node from the trajectory, as measured for the corridor, and from the last sender
+      double dTrajectory = dCorridor;
+      double dLastSource = DistanceToPoint (currentXLoc, currentYLoc, lastsourceXLoc, lastsourceYLoc);
+      double segmentLength = DistanceToPoint (endXLoc, endYLoc, startXLoc, startYLoc);
 
-        }
-      else if (X == 0)
-        {
-          dLastSource = sqrt (pow ((lastsourceXLoc - currentX),2) +
-                              pow ((lastsourceYLoc - currentY),2));
-          dTrajectory = sqrt (pow (dLastSource,2) - pow ((currentY - lastsourceYLoc),2)); // They have the same x value
-        }
-      else
-        {
-          slope = Y / X;
-          b = sourceYLoc - (slope * sourceXLoc);
-          xIntersect = (currentX + slope * currentY - slope * b) / (pow (slope,2) + 1);
-          yIntersect = slope * xIntersect + b;
-          dTrajectory = sqrt (pow ((xIntersect - currentX),2) + pow ((yIntersect - currentY),2));
-          dLastSource = sqrt (pow ((lastsourceXLoc - currentX),2) +
-                              pow ((lastsourceYLoc - currentY),2));
-
-        }
-      /// calculate the delay for each packet and pass it in
-      /// as a time value, ns3 has one class called *Time*
+      /// calculate the delay for each packet with the delay policy,
       /// if the timer expires, we will forward the packet
-
-      if (dTrajectory == 0)
-        {
-          dTrajectory = 1;
-        }
-      try
-        {
-          delayTimer += ALPHA * ((double)(dTrajectory / dLastSource));
-        }
-      catch (int e)
-        {
-          std::cout << "\n\n Unable to calculate delay. dTrajectory=" << dTrajectory << " dLastSource= " << dLastSource << "\n";
-          Simulator::Stop ();
-        }
-
-      /// calculate the delay time here
-      /// The default time is in Second
-      Time delay = Seconds (delayTimer);
+      SiftDelayContext context;
+      context.dTrajectory = dTrajectory;
+      context.dLastSource = dLastSource;
+      context.progress = segmentLength > 0
+        ? (SegmentProgress (currentXLoc, currentYLoc, startXLoc, startYLoc, endXLoc, endYLoc)
+           - SegmentProgress (lastsourceXLoc, lastsourceYLoc, startXLoc, startYLoc, endXLoc, endYLoc)) * segmentLength
+        : dLastSource;
+      context.range = m_corridorWidth;
+      Time delay = GetContentionDelay (context, currentXLoc, currentYLoc);
 
       NS_LOG_DEBUG (" SIFT routing calculation"
                     << "\n\t destYLoc= "  << destYLoc
                     << ", SourceYLoc: " << sourceYLoc
                     << ", destXLoc: "  << destXLoc
                     << ", sourceXLoc: " << sourceXLoc
-                    << "\n\t Slope= x1/x2 = "     << slope
-                    << "\n\t b in y=m+b is sourceYLoc-(slope*sourceXLoc)= "  << b
-                    << "\n\t dTrajectory=  |y1-mx1-b|/Sqrt(m*m+1)= " << dTrajectory
+                    << "\n\t Segment: (" << startXLoc << ", " << startYLoc << ") -> (" << endXLoc << ", " << endYLoc << ")"
+                    << "\n\t dTrajectory: " << dTrajectory
                     << "\n\t dLastSource: " << dLastSource
-                    << "\n\t Y= (destYLoc-sourceYLoc)= "         << Y
-                    << ", X= (destXLoc-sourceXLoc)= "         << X
+                    << "\n\t Progress: " << context.progress
                     << "\n\t Delay: " << delay
                     << "\n\t Current time: " << Seconds (Simulator::Now ()));
 
 
 
       //*** Changed p to packet in the below command
-      ScheduleTimer (packet, delay, sourceAddress, protocol);
+      ScheduleTimer (key, packet, delay, sourceAddress, protocol);
 
     }
 
@@ -927,28 +1394,16 @@ SiftRouting::GetDownTarget6 (void) const
   return MakeNullCallback<void,Ptr<Packet>, Ipv6Address, Ipv6Address, uint8_t, Ptr<Ipv6Route> > ();
 }
 
-uint16_t
+uint32_t
 SiftRouting::GetIDfromIP (Ipv4Address address)
 {
-  int32_t nNodes = NodeList::GetNNodes ();
-  for (int32_t i = 0; i < nNodes; ++i)
+  Ptr<Node> node = GetNodeRegistry ()->GetNode (address);
+  if (node == 0)
     {
-      Ptr<Node> node = NodeList::GetNode (i);
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-
-      int tempint;
-      tempint = ipv4->GetNInterfaces ();
-      for (int j = 1; j < tempint; j++) 
-        {
-          Ipv4InterfaceAddress iaddr = ipv4->GetAddress (j, 0);
-          if (iaddr.GetLocal () == address)
-            {
-              NS_LOG_DEBUG ("Test address " << i << "," << iaddr.GetLocal ());
-              return uint16_t (i);
-            }
-        }
+      return INVALID_NODE_ID;
     }
-  return 256;
+  NS_LOG_DEBUG ("Test address " << node->GetId () << "," << address);
+  return node->GetId ();
 }
 
 Ipv4Address
@@ -956,17 +1411,195 @@ SiftRouting::GetIPfromID (const uint32_t id)
 {
   NS_LOG_FUNCTION (this);
 
-  if (id >= 256)
+  if (id >= NodeList::GetNNodes ())
     {
       NS_LOG_DEBUG ("Exceed the node range");
       return "0.0.0.0";
     }
-  else
+  Ptr<Ipv4> ipv4 = NodeList::GetNode (id)->GetObject<Ipv4> ();
+  if (ipv4 == 0 || ipv4->GetNInterfaces () < 2)
+    {
+      NS_LOG_DEBUG ("Node " << id << " has no address");
+      return "0.0.0.0";
+    }
+  return ipv4->GetAddress (1, 0).GetLocal ();
+}
+
+void
+SiftRouting::UpdateGeographicTuple (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  NS_ASSERT (node != 0);
+  Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
+  UpdateGeographicTuple (node->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal (),
+                         mobility->GetPosition (), mobility->GetVelocity ());
+}
+
+void
+SiftRouting::UpdateGeographicTuple (Ipv4Address address, const Vector &position, const Vector &velocity)
+{
+  NS_LOG_FUNCTION (this << address);
+  Time now = Simulator::Now ();
+  GeographicTuple geoTuple;
+  geoTuple.nodeAddr = address;
+  geoTuple.nodeReceivedFrom = m_mainAddress;
+  geoTuple.recordedTime = now;
+  geoTuple.dataRecordedTime = now;
+  geoTuple.startTime = now;
+  geoTuple.expireTime = Simulator::GetMaximumSimulationTime ();
+  geoTuple.xcoord = (int32_t) position.x;
+  geoTuple.ycoord = (int32_t) position.y;
+  geoTuple.zcoord = (int32_t) position.z;
+  geoTuple.xvelocity = (int16_t) velocity.x;
+  geoTuple.yvelocity = (int16_t) velocity.y;
+  geoTuple.zvelocity = (int16_t) velocity.z;
+  geoTuple.isBeingUpdated = false;
+  geoTuple.isChanged = false;
+  bool needTriggerUpdate = false;
+  m_state.InsertGeographicTuple (geoTuple, needTriggerUpdate);
+  NS_LOG_INFO ("Current Location details: " << geoTuple.nodeAddr
+                                            << " X:" << (int)geoTuple.xcoord
+                                            << " Y:" << (int)geoTuple.ycoord
+                                            << " Z:" << (int)geoTuple.zcoord
+                                            << " Vx:" << (int)geoTuple.xvelocity
+                                            << " Vy:" << (int)geoTuple.yvelocity
+                                            << " Vz:" << (int)geoTuple.zvelocity);
+}
+
+void
+SiftRouting::RefreshGeographicSet ()
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<SiftPositionOracle> oracle = GetPositionOracle ();
+  for (uint32_t nodeNum = 0; nodeNum < oracle->GetNNodes (); nodeNum++)
     {
-      Ptr<Node> node = NodeList::GetNode (id);
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      return ipv4->GetAddress (1, 0).GetLocal ();
+      Ipv4Address address = oracle->GetAddress (nodeNum);
+      if (address != Ipv4Address ())
+        {
+          UpdateGeographicTuple (address, oracle->GetPosition (nodeNum), oracle->GetVelocity (nodeNum));
+        }
     }
+  m_geoRefreshEvent = Simulator::Schedule (m_geoRefreshInterval, &SiftRouting::RefreshGeographicSet, this);
+}
+
+void
+SiftRouting::SendBeacon ()
+{
+  NS_LOG_FUNCTION (this);
+  // The next beacon is jittered by up to a tenth of the interval so that neighbors do not stay in step
+  m_beaconEvent = Simulator::Schedule (Seconds (m_beaconInterval.GetSeconds () * m_uniformRandomVariable->GetValue (0.9, 1.1)),
+                                       &SiftRouting::SendBeacon, this);
+  if (m_mainAddress == Ipv4Address ())
+    {
+      return;
+    }
+  Time now = Simulator::Now ();
+  Ptr<MobilityModel> mobility = GetObject<Node> ()->GetObject<MobilityModel> ();
+  Vector position = mobility->GetPosition ();
+  Vector velocity = mobility->GetVelocity ();
+
+  if (m_beaconSent && m_beaconSuppressionDistance > 0 && now - m_lastBeaconTime < m_beaconMaxInterval)
+    {
+      // Neighbors extrapolate the last beacon; stay silent while that is still accurate
+      double elapsed = (now - m_lastBeaconTime).GetSeconds ();
+      double dx = m_lastBeaconEntry.xLoc + m_lastBeaconEntry.xVelocity * elapsed - position.x;
+      double dy = m_lastBeaconEntry.yLoc + m_lastBeaconEntry.yVelocity * elapsed - position.y;
+      if (std::sqrt (dx * dx + dy * dy) < m_beaconSuppressionDistance)
+        {
+          NS_LOG_DEBUG ("Beacon suppressed, prediction error " << std::sqrt (dx * dx + dy * dy));
+          m_suppressedBeacons++;
+          return;
+        }
+    }
+
+  SiftBeaconHeader beacon;
+  SiftBeaconEntry own;
+  own.address = m_mainAddress;
+  own.xLoc = (int32_t) position.x;
+  own.yLoc = (int32_t) position.y;
+  own.xVelocity = (int16_t) velocity.x;
+  own.yVelocity = (int16_t) velocity.y;
+  own.age = 0;
+  beacon.AddEntry (own);
+
+  // Gossip the freshest positions heard from other nodes so that they spread beyond one hop
+  const GeographicSet &set = m_state.GetGeographicInfo ();
+  std::vector<std::pair<Time, uint32_t> > candidates;
+  for (uint32_t slot = 0; slot < set.size (); ++slot)
+    {
+      const GeographicTuple &tuple = set[slot];
+      if (tuple.nodeAddr == m_mainAddress || tuple.expireTime < now || now - tuple.recordedTime > m_locationTimeout)
+        {
+          continue;
+        }
+      candidates.push_back (std::make_pair (tuple.recordedTime, slot));
+    }
+  uint32_t count = std::min<uint32_t> (m_beaconGossipEntries, candidates.size ());
+  std::partial_sort (candidates.begin (), candidates.begin () + count, candidates.end (),
+                     std::greater<std::pair<Time, uint32_t> > ());
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      const GeographicTuple &tuple = set[candidates[i].second];
+      SiftBeaconEntry entry;
+      entry.address = tuple.nodeAddr;
+      entry.xLoc = (int32_t) tuple.xcoord;
+      entry.yLoc = (int32_t) tuple.ycoord;
+      entry.xVelocity = tuple.xvelocity;
+      entry.yVelocity = tuple.yvelocity;
+      entry.age = std::min<int64_t> ((now - tuple.recordedTime).GetMilliSeconds (), 0xffff);
+      beacon.AddEntry (entry);
+    }
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (beacon);
+  m_beaconSent = true;
+  m_lastBeaconTime = now;
+  m_lastBeaconEntry = own;
+  m_beaconTxTrace (packet);
+  SendPacket (packet, m_mainAddress, m_broadcast, GetProtocolNumber ());
+}
+
+enum IpL4Protocol::RxStatus
+SiftRouting::ReceiveBeacon (Ptr<Packet> packet, Ipv4Address from)
+{
+  NS_LOG_FUNCTION (this << packet << from);
+  m_beaconRxTrace (packet);
+  SiftBeaconHeader beacon;
+  packet->RemoveHeader (beacon);
+  Time now = Simulator::Now ();
+  const std::vector<SiftBeaconEntry> &entries = beacon.GetEntries ();
+  for (std::vector<SiftBeaconEntry>::const_iterator it = entries.begin (); it != entries.end (); ++it)
+    {
+      if (it->address == m_mainAddress)
+        {
+          continue;
+        }
+      Time recorded = now - MilliSeconds (it->age);
+      GeographicTuple *known = m_state.FindGeographicTuple (it->address);
+      if (known != NULL && known->expireTime >= now && known->recordedTime >= recorded)
+        {
+          // What this node knows is at least as fresh
+          continue;
+        }
+      GeographicTuple tuple;
+      tuple.nodeAddr = it->address;
+      tuple.nodeReceivedFrom = from;
+      tuple.xcoord = it->xLoc;
+      tuple.ycoord = it->yLoc;
+      tuple.zcoord = 0;
+      tuple.xvelocity = it->xVelocity;
+      tuple.yvelocity = it->yVelocity;
+      tuple.zvelocity = 0;
+      tuple.recordedTime = recorded;
+      tuple.dataRecordedTime = now;
+      tuple.startTime = now;
+      tuple.expireTime = recorded + m_locationTimeout;
+      tuple.isBeingUpdated = false;
+      tuple.isChanged = false;
+      bool needTriggerUpdate = false;
+      m_state.InsertGeographicTuple (tuple, needTriggerUpdate);
+    }
+  return IpL4Protocol::RX_OK;
 }
 
 void SiftRouting::AddGeographicTuple (const GeographicTuple &tuple)
@@ -999,23 +1632,121 @@ void SiftRouting::PrintSiftHeader (SiftHeader siftHeader, GeographicTuple geoTup
    << "dest YLoc= " << destYLoc << std::endl;
 }
 
-void SiftRouting::PrintReceiveBuffer ()
+bool
+SiftRouting::IsDuplicate (const SiftPacketKey &key)
 {
-  std::map<Ptr<Packet>, Time> receiveBuffer;
-  receiveBuffer = GetReceiveBuffer ();
-  for (std::map<Ptr<Packet>,Time >::iterator it = receiveBuffer.begin (); it != receiveBuffer.end (); ++it)
+  switch (m_duplicateDetection)
     {
-      std::cout << *it->first << "=>" << it->second << '\n';
+    case SEQUENCE_WINDOW:
+      return m_seqWindow.Lookup (key);
+    case BLOOM_FILTER:
+      {
+        bool falsePositive = false;
+        bool duplicate = m_bloomFilter.Lookup (key, falsePositive);
+        if (falsePositive)
+          {
+            m_suspectedFalsePositives++;
+          }
+        return duplicate;
+      }
+    case DUPLICATE_CACHE:
+    default:
+      return m_buffer.Lookup (key);
     }
+}
 
+void
+SiftRouting::RecordPacket (const SiftPacketKey &key)
+{
+  switch (m_duplicateDetection)
+    {
+    case SEQUENCE_WINDOW:
+      m_seqWindow.Insert (key);
+      break;
+    case BLOOM_FILTER:
+      if (m_bloomFilter.Insert (key))
+        {
+          m_bloomEarlyRotations++;
+        }
+      break;
+    case DUPLICATE_CACHE:
+    default:
+      m_buffer.Insert (key);
+      break;
+    }
+}
 
+void SiftRouting::PrintReceiveBuffer ()
+{
+  switch (m_duplicateDetection)
+    {
+    case SEQUENCE_WINDOW:
+      m_seqWindow.Print (std::cout);
+      break;
+    case BLOOM_FILTER:
+      m_bloomFilter.Print (std::cout);
+      break;
+    case DUPLICATE_CACHE:
+    default:
+      m_buffer.Print (std::cout);
+      break;
+    }
 }
 
-std::map<Ptr<Packet>, Time> SiftRouting::GetReceiveBuffer ()
+SiftDuplicateCache & SiftRouting::GetReceiveBuffer ()
 {
   return m_buffer;
 }
 
+void
+SiftRouting::SetDuplicateLifetime (Time lifetime)
+{
+  m_buffer.SetLifetime (lifetime);
+  m_seqWindow.SetLifetime (lifetime);
+  m_bloomFilter.SetLifetime (lifetime);
+}
+
+Time
+SiftRouting::GetDuplicateLifetime (void) const
+{
+  return m_buffer.GetLifetime ();
+}
+
+void
+SiftRouting::SetGeoGridCellSize (double cellSize)
+{
+  m_state.SetGridCellSize (cellSize);
+}
+
+double
+SiftRouting::GetGeoGridCellSize (void) const
+{
+  return m_state.GetGridCellSize ();
+}
+
+void
+SiftRouting::SetBloomCapacity (uint32_t capacity)
+{
+  m_bloomFilter.SetCapacity (capacity);
+}
+
+uint32_t
+SiftRouting::GetBloomCapacity (void) const
+{
+  return m_bloomFilter.GetCapacity ();
+}
+
+void
+SiftRouting::SetBloomFalsePositiveRate (double rate)
+{
+  m_bloomFilter.SetFalsePositiveRate (rate);
+}
+
+double
+SiftRouting::GetBloomFalsePositiveRate (void) const
+{
+  return m_bloomFilter.GetFalsePositiveRate ();
+}
 
 }  /* namespace sift */
 }  /* namespace ns3 */
@@ -35,6 +35,7 @@
 #include <map>
 #include <list>
 #include <vector>
+#include <unordered_map>
 #include <stdint.h>
 #include <cassert>
 #include <sys/types.h>
@@ -54,9 +55,11 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/timer.h"
+#include "ns3/event-id.h"
 #include "ns3/net-device.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/socket.h"
@@ -64,6 +67,10 @@
 #include "ns3/test.h"
 #include "sift-header.h"
 #include "sift-geo.h"
+#include "sift-duplicate-cache.h"
+#include "sift-node-registry.h"
+#include "sift-position-oracle.h"
+#include "sift-delay-policy.h"
 
 namespace ns3 {
 
@@ -94,6 +101,60 @@ public:
     * \brief Define the sift protocol number.
     */
   static const uint8_t PROT_NUMBER;
+  /**
+    * \brief Node id returned for an address that no node holds.
+    */
+  static const uint32_t INVALID_NODE_ID;
+  /**
+   * \brief How a node decides that a received packet was already seen.
+   */
+  enum DuplicateDetection
+  {
+    DUPLICATE_CACHE,      ///< exact cache of packet keys with a lifetime
+    SEQUENCE_WINDOW,      ///< sliding sequence number window per origin
+    BLOOM_FILTER          ///< rotating Bloom filter with a fixed memory budget
+  };
+  /**
+   * \brief Where the source of a packet learns the position of its destination.
+   */
+  enum LocationService
+  {
+    ORACLE_LOCATION,      ///< read from the mobility model of the destination
+    BEACON_LOCATION       ///< learned from the position beacons of the other nodes
+  };
+  /**
+   * \brief How a relay sets its contention timer, see sift-delay-policy.h.
+   */
+  enum DelayPolicy
+  {
+    RATIO_DELAY,          ///< distance from the trajectory over distance from the last sender
+    PROGRESS_DELAY,       ///< advance along the trajectory over the last sender
+    DISTANCE_DELAY,       ///< distance from the trajectory only
+    DENSITY_DELAY         ///< the ratio, scaled by the number of neighbors
+  };
+  /**
+   * \brief How a relay counts its neighbors for the density delay policy.
+   */
+  enum DensityEstimate
+  {
+    GEO_DENSITY,          ///< known nodes of the geographic set within range
+    OVERHEARD_DENSITY     ///< distinct senders of the SiFT frames heard recently
+  };
+  /**
+   * \brief Why a packet was dropped.
+   */
+  enum DropReason
+  {
+    DROP_NO_POSITION,     ///< the source knows no position for the destination
+    DROP_OFF_CORRIDOR,    ///< the relay is farther than CorridorWidth from the trajectory
+    DROP_TTL_EXPIRED      ///< the packet has no hop left to be forwarded
+  };
+  /**
+   * \brief TracedCallback signature for packets dropped with a reason.
+   * \param [in] packet the dropped packet
+   * \param [in] reason why it was dropped
+   */
+  typedef void (* DropReasonTracedCallback)(Ptr<const Packet> packet, DropReason reason);
   /**
    * \brief Constructor.
    */
@@ -118,6 +179,16 @@ public:
     * \return the node associated with the ip address
     */
   Ptr<Node> GetNodeWithAddress (Ipv4Address ipv4Address);
+  /**
+    * \brief Set the registry used to find the node of an address.
+    * \param registry the registry, usually shared by all the agents installed by a helper
+    */
+  void SetNodeRegistry (Ptr<SiftNodeRegistry> registry);
+  /**
+    * \brief Get the registry used to find the node of an address.
+    * \return the registry; one covering NodeList is created if none was set
+    */
+  Ptr<SiftNodeRegistry> GetNodeRegistry (void);
   /**
     * \brief Print the route vector.
     */
@@ -148,7 +219,18 @@ public:
   void ForwardPacket (Ptr<Packet> packet,
                       Ipv4Address source,
                       uint8_t protocol);
-  void ScheduleTimer (Ptr<Packet> packet, Time timer, Ipv4Address source, uint8_t protocol);
+  /**
+   * \brief Schedule the contention timer of a packet waiting to be forwarded.
+   *
+   * If a forward of the same packet is already pending, the packet has been overheard
+   * again and the pending forward is cancelled instead.
+   * \param key the key of the packet
+   * \param packet the packet to forward when the timer expires
+   * \param timer the contention delay
+   * \param source the source address of the packet
+   * \param protocol the protocol number
+   */
+  void ScheduleTimer (const SiftPacketKey &key, Ptr<Packet> packet, Time timer, Ipv4Address source, uint8_t protocol);
   /**
    * \param p packet to forward up
    * \param header IPv4 Header information
@@ -186,19 +268,103 @@ public:
    * \return the number of stream indices assigned by this model
    */
   int64_t AssignStreams (int64_t stream);
+  /**
+   * \brief Draw the random delay added to a contention timer.
+   * \returns a delay between 0 and MaxJitter, 0 if MaxJitter is 0
+   */
+  Time GetJitter (void);
   void AddGeographicTuple (const GeographicTuple &tuple);
   SiftGeo m_state;
 
+  /**
+   * \brief Add a node to the position oracle of this agent.
+   * \param node the node
+   */
   void AddNode (Ptr<Node> node);
-
+  /**
+   * \return the number of nodes in the position oracle
+   */
   uint32_t GetNodesSize (void);
+  /**
+   * \brief Set the oracle giving the positions of all the nodes.
+   * \param oracle the oracle, usually shared by all the agents installed by a helper
+   */
+  void SetPositionOracle (Ptr<SiftPositionOracle> oracle);
+  /**
+   * \brief Get the oracle giving the positions of all the nodes.
+   * \return the oracle; an empty one is created if none was set
+   */
+  Ptr<SiftPositionOracle> GetPositionOracle (void);
+  /**
+   * \brief Callback giving the waypoints of the trajectory from a source position to a
+   * destination position.
+   */
+  typedef Callback<std::vector<SiftWaypoint>, Vector, Vector> WaypointCallback;
+  /**
+   * \brief Set the callback that gives the waypoints of the packets this node sends.
+   * \param callback the callback; without one the trajectory is the straight line to the destination
+   */
+  void SetWaypointCallback (WaypointCallback callback);
+  /**
+   * \return the number of destinations whose trajectory is cached, expired ones included
+   * until they are swept
+   */
+  uint32_t GetNCachedTrajectories (void) const;
 
-  void  CancelTimer (Ptr<Packet> p);
+  /**
+   * \brief Cancel the pending forward of a packet, if there is one.
+   * \param key the key of the packet
+   */
+  void  CancelTimer (const SiftPacketKey &key);
 
   //void SiftRouting::CheckParameters (Ipv4Header const ip, Ipv4Header ipHeader);
 
   void PrintReceiveBuffer (void);
-  std::map<Ptr<Packet>, Time> GetReceiveBuffer (void);
+  /**
+   * \brief Get the cache of packets already seen by this node.
+   * \return the duplicate cache
+   */
+  SiftDuplicateCache & GetReceiveBuffer (void);
+  /**
+   * \brief Set how long a received packet is remembered for duplicate detection.
+   * \param lifetime the lifetime of a duplicate cache entry
+   */
+  void SetDuplicateLifetime (Time lifetime);
+  /**
+   * \brief Get how long a received packet is remembered for duplicate detection.
+   * \return the lifetime of a duplicate cache entry
+   */
+  Time GetDuplicateLifetime (void) const;
+  /**
+   * \brief Set the cell size of the spatial index over the geographic set.
+   * \param cellSize the side of a cell in meters
+   */
+  void SetGeoGridCellSize (double cellSize);
+  /**
+   * \brief Get the cell size of the spatial index over the geographic set.
+   * \return the side of a cell in meters
+   */
+  double GetGeoGridCellSize (void) const;
+  /**
+   * \brief Set the number of packets one Bloom filter generation is sized for.
+   * \param capacity the capacity of a generation
+   */
+  void SetBloomCapacity (uint32_t capacity);
+  /**
+   * \brief Get the number of packets one Bloom filter generation is sized for.
+   * \return the capacity of a generation
+   */
+  uint32_t GetBloomCapacity (void) const;
+  /**
+   * \brief Set the target false positive rate of the Bloom filter.
+   * \param rate the false positive rate
+   */
+  void SetBloomFalsePositiveRate (double rate);
+  /**
+   * \brief Get the target false positive rate of the Bloom filter.
+   * \return the false positive rate
+   */
+  double GetBloomFalsePositiveRate (void) const;
 
   uint16_t GetSeqNo ();
   void SetSeqNo (uint16_t sno);
@@ -219,10 +385,141 @@ protected:
    * The trace for drop, receive and send data packets
    */
   TracedCallback<Ptr<const Packet> > m_dropTrace;
+  TracedCallback<Ptr<const Packet>, DropReason> m_dropReasonTrace;
   TracedCallback <const SiftHeader &> m_txPacketTrace;
+  /**
+   * Number of Bloom filter matches for packets that cannot have been seen before
+   */
+  TracedValue<uint32_t> m_suspectedFalsePositives;
+  /**
+   * Number of Bloom filter generations retired before half the lifetime because they were full
+   */
+  TracedValue<uint32_t> m_bloomEarlyRotations;
+  /**
+   * The trace for sent and received position beacons
+   */
+  TracedCallback<Ptr<const Packet> > m_beaconTxTrace;
+  TracedCallback<Ptr<const Packet> > m_beaconRxTrace;
+  /**
+   * Number of beacons not sent because the last one still predicts this node well enough
+   */
+  TracedValue<uint32_t> m_suppressedBeacons;
+  /**
+   * Number of packets this node did not forward because their TTL ran out
+   */
+  TracedValue<uint32_t> m_hopLimitDrops;
+  /**
+   * The trace for packets this node forwarded at about the same time as another relay
+   */
+  TracedCallback<Ptr<const Packet> > m_timerCollisionTrace;
 
 private:
   void Start ();
+  /**
+   * \brief Check whether a packet was already seen, using the configured duplicate detection.
+   * \param key the key of the packet
+   * \return true if the packet is a duplicate
+   */
+  bool IsDuplicate (const SiftPacketKey &key);
+  /**
+   * \brief Read the position and velocity of a node from its mobility model into the geographic set.
+   * \param node the node to refresh
+   */
+  void UpdateGeographicTuple (Ptr<Node> node);
+  /**
+   * \brief Record the position and velocity of a node in the geographic set.
+   * \param address the address of the node
+   * \param position its position
+   * \param velocity its velocity
+   */
+  void UpdateGeographicTuple (Ipv4Address address, const Vector &position, const Vector &velocity);
+  /**
+   * \brief Refresh the geographic set for all known nodes and reschedule itself.
+   */
+  void RefreshGeographicSet ();
+  /**
+   * \brief Broadcast a position beacon, unless it is suppressed, and schedule the next one.
+   */
+  void SendBeacon ();
+  /**
+   * \brief Record the positions carried by a beacon in the geographic set.
+   * \param packet the beacon
+   * \param from the address of the sender
+   * \return the receive status
+   */
+  enum IpL4Protocol::RxStatus ReceiveBeacon (Ptr<Packet> packet, Ipv4Address from);
+  /**
+   * \brief Get the header of a new packet with the positions of its trajectory filled in.
+   * \param source the source address
+   * \param destination the destination address
+   * \param protocol the protocol carried by the packet
+   * \param header filled with the positions, the sequence number and the TTL are left to the caller
+   * \return false if the position of the destination is not known
+   *
+   * The header is taken from the trajectory cache while it is younger than TrajectoryCacheLifetime
+   * and this node has moved less than TrajectoryCacheDistance since it was built.
+   */
+  bool GetTrajectoryHeader (Ipv4Address source, Ipv4Address destination, uint8_t protocol, SiftHeader &header);
+  /**
+   * \brief Build the header of a new packet from the current positions.
+   * \param source the source address
+   * \param destination the destination address
+   * \param protocol the protocol carried by the packet
+   * \param header filled with the positions
+   * \param destVelocity set to the velocity of the destination the position was read or predicted with
+   * \return false if the position of the destination is not known
+   */
+  bool BuildTrajectoryHeader (Ipv4Address source, Ipv4Address destination, uint8_t protocol, SiftHeader &header,
+                              Vector &destVelocity);
+  /**
+   * \brief Report a dropped packet to the DropReason trace, and to the Drop trace unless
+   * the packet was only filtered out of the corridor.
+   * \param packet the packet
+   * \param reason why it is dropped
+   */
+  void DropPacket (Ptr<const Packet> packet, DropReason reason);
+  /**
+   * \brief Contention delay of this node with the configured delay policy.
+   * \param context the position of this node, neighbors is filled when the policy needs it
+   * \param x x coordinate of this node
+   * \param y y coordinate of this node
+   * \return the time to wait before forwarding the packet
+   */
+  Time GetContentionDelay (SiftDelayContext &context, double x, double y);
+  /**
+   * \brief Contention delay of this node with one delay policy.
+   * \param context the position of this node, neighbors is filled when the policy needs it
+   * \param x x coordinate of this node
+   * \param y y coordinate of this node
+   * \return the time to wait before forwarding the packet
+   */
+  template <class Policy>
+  Time GetContentionDelay (SiftDelayContext &context, double x, double y);
+  /**
+   * \brief Whether neighbors are counted from the SiFT frames this node hears.
+   * \return true with the density delay policy and the overheard density estimate, or the
+   * geographic estimate over a geographic set that is never refreshed
+   */
+  bool IsOverhearingNeighbors (void) const;
+  /**
+   * \brief Remember the sender of a SiFT frame heard by this node.
+   * \param sender IP source of the frame, the node that sent or forwarded it
+   */
+  void RecordOverheardNeighbor (Ipv4Address sender);
+  /**
+   * \brief Forget the senders not heard within DensityWindow and count the others.
+   * \return the number of senders heard within DensityWindow
+   */
+  uint32_t CountOverheardNeighbors (void);
+  /**
+   * \brief Record a packet in the configured duplicate detection.
+   * \param key the key of the packet
+   */
+  void RecordPacket (const SiftPacketKey &key);
+  /**
+   * \brief Called when the contention timer of a packet expires.
+   */
+  void ContentionTimerExpire (SiftPacketKey key, Ptr<Packet> packet, Ipv4Address source, uint8_t protocol);
 
   Ptr<Ipv4L3Protocol> m_ipv4;                            ///< Ipv4l3Protocol
 
@@ -242,15 +539,64 @@ private:
   uint16_t m_seqNo;
 
 
-  std::map<Ptr<Packet>, Timer> m_timer; ///< The timer to provide timing for each packet, the key is the packet itself TODO
+  typedef std::unordered_map<SiftPacketKey, EventId, SiftPacketKeyHash> ContentionTimerTable;
+  ContentionTimerTable m_timer; ///< The pending contention timer of each packet waiting to be forwarded
+  typedef std::unordered_map<SiftPacketKey, Time, SiftPacketKeyHash> ForwardTimeTable;
+  ForwardTimeTable m_recentForwards; ///< Packets forwarded by this node within the last two transmission times
   // std::map<Ptr<Packet>, Timer> m_sentPacket;
-  std::map<Ptr<Packet>, Time> m_buffer;                                 // Keeps received packets to control duplicate ones
+  SiftDuplicateCache m_buffer;                                          ///< Keeps keys of received packets to control duplicate ones
+  SiftSequenceWindow m_seqWindow;                                       ///< Per origin sequence windows to control duplicate ones
+  SiftBloomFilter m_bloomFilter;                                        ///< Fixed size filter to control duplicate ones
+  enum DuplicateDetection m_duplicateDetection;                         ///< Which of the three above is used
+  Time m_geoRefreshInterval;                                            ///< Period of the geographic set refresh, zero if disabled
+  EventId m_geoRefreshEvent;                                            ///< Next geographic set refresh
+  Ptr<SiftNodeRegistry> m_registry;                                     ///< Address -> node lookups
+  Time m_predictionStaleness;                                           ///< Age up to which a destination position is predicted, zero if disabled
+  enum LocationService m_locationService;                               ///< Where destination positions come from
+  Time m_beaconInterval;                                                ///< Period of the position beacons
+  Time m_beaconMaxInterval;                                             ///< Longest time between two beacons when they are suppressed
+  double m_beaconSuppressionDistance;                                   ///< Prediction error below which a beacon is suppressed, zero to never suppress
+  uint32_t m_beaconGossipEntries;                                       ///< Positions of other nodes carried by a beacon
+  Time m_locationTimeout;                                               ///< Age after which a position learned from beacons is not used
+  EventId m_beaconEvent;                                                ///< Next beacon
+  bool m_beaconSent;                                                    ///< Whether this node has sent a beacon
+  Time m_lastBeaconTime;                                                ///< When the last beacon was sent
+  SiftBeaconEntry m_lastBeaconEntry;                                    ///< Position of this node in the last beacon
+
+  /// A header prepared by the source for one destination
+  struct TrajectoryCacheEntry
+  {
+    SiftHeader header;                                                  ///< Header with the positions of the trajectory
+    Time created;                                                       ///< When the positions were read
+    Vector destVelocity;                                                ///< Velocity of the destination at that time
+  };
+  typedef std::unordered_map<Ipv4Address, TrajectoryCacheEntry, Ipv4AddressHash> TrajectoryCache;
+  TrajectoryCache m_trajectoryCache;                                    ///< Trajectory of the packets sent to each destination
+  Time m_trajectoryCachePurge;                                          ///< Last time expired trajectories were dropped
+  Time m_trajectoryCacheLifetime;                                       ///< Time a cached trajectory is used, zero if disabled
+  double m_trajectoryCacheDistance;                                     ///< Movement of this node that invalidates a cached trajectory
+  double m_corridorWidth;                                               ///< Largest distance from the trajectory at which this node relays
+  bool m_compactHeader;                                                 ///< Whether packets are sent with the compact header format
+  enum DelayPolicy m_delayPolicy;                                       ///< How the contention timer is set
+  double m_alpha;                                                       ///< Scale of the contention delay, in seconds
+  Time m_transmissionTime;                                              ///< Shortest contention delay, the time of one transmission
+  uint32_t m_referenceNeighbors;                                        ///< Neighbors at which the density policy matches the ratio
+  Time m_maxJitter;                                                     ///< Largest random delay added to a contention timer
+  Time m_collisionWindow;                                               ///< Time after a forward in which another copy is a collision
+  double m_densityMinScale;                                             ///< Smallest scale of the weight by the density policy
+  double m_densityMaxScale;                                             ///< Largest scale of the weight by the density policy
+  enum DensityEstimate m_densityEstimate;                               ///< How neighbors are counted for the density policy
+  Time m_densityWindow;                                                 ///< Time a sender heard by this node counts as a neighbor
+  /// Last time a frame was heard from each sender
+  typedef std::unordered_map<Ipv4Address, Time, Ipv4AddressHash> OverheardNeighbors;
+  OverheardNeighbors m_overheardNeighbors;                              ///< Senders heard within DensityWindow
+  WaypointCallback m_waypointCallback;                                  ///< Waypoints of the packets sent by this node
 
 private:
-  uint16_t GetIDfromIP (Ipv4Address address);
+  uint32_t GetIDfromIP (Ipv4Address address);                 ///< IP -> node id, INVALID_NODE_ID if unknown
   Ipv4Address GetIPfromID (const uint32_t id);                ///< node id -> IP
   GeographicSet m_geoSet;                                     ///< the geographical set
-  std::vector<Ptr<Node> > m_nodePtrs;
+  Ptr<SiftPositionOracle> m_oracle;                           ///< positions of all the nodes
 };
 }  /* namespace sift */
 }  /* namespace ns3 */
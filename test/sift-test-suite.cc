@@ -30,6 +30,8 @@
  */
 
 #include <vector>
+#include <algorithm>
+#include <cmath>
 #include "ns3/ptr.h"
 #include "ns3/boolean.h"
 #include "ns3/test.h"
@@ -40,6 +42,8 @@
 #include "ns3/uinteger.h"
 #include "ns3/string.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-interface-address.h"
 
 #include "ns3/dsr-fs-header.h"
 #include "ns3/dsr-option-header.h"
@@ -48,6 +52,25 @@
 #include "ns3/dsr-rsendbuff.h"
 #include "ns3/dsr-main-helper.h"
 #include "ns3/dsr-helper.h"
+#include "ns3/sift-delay-policy.h"
+#include "ns3/sift-duplicate-cache.h"
+#include "ns3/sift-geo.h"
+#include "ns3/sift-geometry.h"
+#include "ns3/sift-header.h"
+#include "ns3/sift-node-registry.h"
+#include "ns3/sift-position-oracle.h"
+#include "ns3/sift-road-map.h"
+#include "ns3/sift-routing.h"
+#include "ns3/sift-helper.h"
+#include "ns3/sift-main-helper.h"
+#include "ns3/nstime.h"
+#include "ns3/udp-header.h"
+#include "ns3/simple-channel.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv4-l3-protocol.h"
 
 namespace ns3 {
 namespace dsr {
@@ -521,3 +544,1561 @@ public:
 } g_dsrTestSuite;
 } // namespace dsr
 } // namespace ns3
+
+namespace ns3 {
+namespace sift {
+
+// -----------------------------------------------------------------------------
+// / Unit test for the SiFT duplicate cache
+class SiftDuplicateCacheTest : public TestCase
+{
+public:
+  SiftDuplicateCacheTest ();
+  ~SiftDuplicateCacheTest ();
+  virtual void
+  DoRun (void);
+  void CheckExpire ();
+
+  SiftDuplicateCache cache;
+};
+SiftDuplicateCacheTest::SiftDuplicateCacheTest ()
+  : TestCase ("SiFT duplicate cache"),
+    cache ()
+{
+}
+SiftDuplicateCacheTest::~SiftDuplicateCacheTest ()
+{
+}
+void
+SiftDuplicateCacheTest::DoRun ()
+{
+  cache.SetLifetime (Seconds (3));
+  NS_TEST_EXPECT_MSG_EQ (cache.GetLifetime (), Seconds (3), "trivial");
+
+  SiftPacketKey key;
+  key.source = Ipv4Address ("10.1.1.1");
+  key.destination = Ipv4Address ("10.1.1.2");
+  key.seqNo = 1;
+  NS_TEST_EXPECT_MSG_EQ (cache.Lookup (key), false, "trivial");
+  cache.Insert (key);
+  NS_TEST_EXPECT_MSG_EQ (cache.Lookup (key), true, "trivial");
+
+  SiftPacketKey other = key;
+  other.seqNo = 2;
+  NS_TEST_EXPECT_MSG_EQ (cache.Lookup (other), false, "Seq no is part of the key");
+  other.seqNo = 1;
+  other.destination = Ipv4Address ("10.1.1.3");
+  NS_TEST_EXPECT_MSG_EQ (cache.Lookup (other), false, "Destination is part of the key");
+  cache.Insert (other);
+  NS_TEST_EXPECT_MSG_EQ (cache.GetSize (), 2, "trivial");
+
+  Simulator::Schedule (Seconds (4), &SiftDuplicateCacheTest::CheckExpire, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+void
+SiftDuplicateCacheTest::CheckExpire ()
+{
+  SiftPacketKey key;
+  key.source = Ipv4Address ("10.1.1.1");
+  key.destination = Ipv4Address ("10.1.1.2");
+  key.seqNo = 1;
+  NS_TEST_EXPECT_MSG_EQ (cache.Lookup (key), false, "Entry must have expired");
+  NS_TEST_EXPECT_MSG_EQ (cache.GetSize (), 0, "Must be empty now");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the SiFT per origin sequence window
+class SiftSequenceWindowTest : public TestCase
+{
+public:
+  SiftSequenceWindowTest ();
+  ~SiftSequenceWindowTest ();
+  virtual void
+  DoRun (void);
+  void CheckResume ();
+
+  SiftSequenceWindow window;
+};
+SiftSequenceWindowTest::SiftSequenceWindowTest ()
+  : TestCase ("SiFT sequence window"),
+    window ()
+{
+}
+SiftSequenceWindowTest::~SiftSequenceWindowTest ()
+{
+}
+void
+SiftSequenceWindowTest::DoRun ()
+{
+  window.SetLifetime (Seconds (3));
+  NS_TEST_EXPECT_MSG_EQ (window.GetLifetime (), Seconds (3), "trivial");
+  SiftPacketKey key;
+  key.source = Ipv4Address ("10.1.1.1");
+  key.destination = Ipv4Address ("10.1.1.2");
+
+  key.seqNo = 10;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), false, "trivial");
+  window.Insert (key);
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), true, "trivial");
+  key.seqNo = 8;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), false, "Out of order packet inside the window");
+  window.Insert (key);
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), true, "trivial");
+  key.seqNo = 9;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), false, "trivial");
+
+  // Wrap around of the 16 bit counter
+  key.source = Ipv4Address ("10.1.1.4");
+  key.seqNo = 65534;
+  window.Insert (key);
+  key.seqNo = 1;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), false, "Seq no after the wrap is newer");
+  window.Insert (key);
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), true, "trivial");
+  key.seqNo = 65534;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), true, "Seq no before the wrap is kept in the window");
+  key.seqNo = 65535;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), false, "trivial");
+  key.seqNo = 65000;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), true, "Older than the window");
+
+  key.source = Ipv4Address ("10.1.1.3");
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), false, "Windows are per origin");
+  NS_TEST_EXPECT_MSG_EQ (window.GetSize (), 2, "trivial");
+
+  // Half the sequence space later, new packets look older than the window...
+  key.source = Ipv4Address ("10.1.1.1");
+  key.seqNo = 40010;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), true, "Too far ahead, taken for an old packet");
+
+  Simulator::Schedule (Seconds (4), &SiftSequenceWindowTest::CheckResume, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+void
+SiftSequenceWindowTest::CheckResume ()
+{
+  // ...until the window of the silent origin is forgotten
+  SiftPacketKey key;
+  key.source = Ipv4Address ("10.1.1.1");
+  key.destination = Ipv4Address ("10.1.1.2");
+  key.seqNo = 40010;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), false, "The origin resumes after a silence");
+  window.Insert (key);
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), true, "trivial");
+  key.seqNo = 40009;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), false, "A new window below the resumed packet");
+  key.seqNo = 39910;
+  NS_TEST_EXPECT_MSG_EQ (window.Lookup (key), true, "Older than the new window");
+  NS_TEST_EXPECT_MSG_EQ (window.GetSize (), 1, "The other silent origin is dropped");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the SiFT Bloom duplicate filter
+class SiftBloomFilterTest : public TestCase
+{
+public:
+  SiftBloomFilterTest ();
+  ~SiftBloomFilterTest ();
+  virtual void
+  DoRun (void);
+};
+SiftBloomFilterTest::SiftBloomFilterTest ()
+  : TestCase ("SiFT Bloom filter")
+{
+}
+SiftBloomFilterTest::~SiftBloomFilterTest ()
+{
+}
+void
+SiftBloomFilterTest::DoRun ()
+{
+  SiftBloomFilter filter;
+  filter.SetCapacity (1000);
+  filter.SetFalsePositiveRate (0.01);
+  NS_TEST_EXPECT_MSG_EQ (filter.GetBits (), 9600, "m = -n ln(p) / ln(2)^2, rounded up to 64 bits");
+  NS_TEST_EXPECT_MSG_EQ (filter.GetHashes (), 7, "k = (m / n) ln(2)");
+
+  SiftPacketKey key;
+  key.source = Ipv4Address ("10.1.1.1");
+  key.destination = Ipv4Address ("10.1.1.2");
+  bool falsePositive = false;
+  for (uint16_t i = 1; i <= 500; ++i)
+    {
+      key.seqNo = i;
+      filter.Insert (key);
+    }
+  for (uint16_t i = 1; i <= 500; ++i)
+    {
+      key.seqNo = i;
+      NS_TEST_EXPECT_MSG_EQ (filter.Lookup (key, falsePositive), true, "No false negative");
+      NS_TEST_EXPECT_MSG_EQ (falsePositive, false, "trivial");
+    }
+  for (uint16_t i = 501; i <= 1000; ++i)
+    {
+      key.seqNo = i;
+      NS_TEST_EXPECT_MSG_EQ (filter.Lookup (key, falsePositive), false, "Newer seq no is never a duplicate");
+    }
+  key.source = Ipv4Address ("10.1.1.9");
+  key.seqNo = 1;
+  NS_TEST_EXPECT_MSG_EQ (filter.Lookup (key, falsePositive), false, "Unknown origin is never a duplicate");
+
+  // A full generation is retired early, and an origin is forgotten with its last generation
+  SiftBloomFilter small;
+  small.SetCapacity (100);
+  key.source = Ipv4Address ("10.1.1.1");
+  uint32_t early = 0;
+  for (uint16_t i = 1; i <= 100; ++i)
+    {
+      key.seqNo = i;
+      early += small.Insert (key);
+    }
+  NS_TEST_EXPECT_MSG_EQ (early, 1, "The 100th packet fills the generation");
+  key.seqNo = 50;
+  NS_TEST_EXPECT_MSG_EQ (small.Lookup (key, falsePositive), true, "Still in the previous generation");
+  key.source = Ipv4Address ("10.1.1.2");
+  for (uint16_t i = 1; i <= 100; ++i)
+    {
+      key.seqNo = i;
+      early += small.Insert (key);
+    }
+  NS_TEST_EXPECT_MSG_EQ (early, 2, "Another full generation");
+  key.source = Ipv4Address ("10.1.1.1");
+  key.seqNo = 50;
+  NS_TEST_EXPECT_MSG_EQ (small.Lookup (key, falsePositive), false, "Forgotten after two early rotations");
+  NS_TEST_EXPECT_MSG_EQ (falsePositive, false, "trivial");
+  key.source = Ipv4Address ("10.1.1.2");
+  NS_TEST_EXPECT_MSG_EQ (small.Lookup (key, falsePositive), true, "Packets of the previous generation are kept");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the SiFT geographic set
+class SiftGeoTest : public TestCase
+{
+public:
+  SiftGeoTest ();
+  ~SiftGeoTest ();
+  virtual void
+  DoRun (void);
+};
+SiftGeoTest::SiftGeoTest ()
+  : TestCase ("SiFT geographic set")
+{
+}
+SiftGeoTest::~SiftGeoTest ()
+{
+}
+void
+SiftGeoTest::DoRun ()
+{
+  SiftGeo geo;
+  bool needTriggerUpdate = false;
+  GeographicTuple tuple;
+  tuple.xcoord = 10;
+  tuple.ycoord = 20;
+  tuple.zcoord = 0;
+  tuple.xvelocity = 1;
+  tuple.yvelocity = 0;
+  tuple.zvelocity = 0;
+  tuple.isBeingUpdated = false;
+  tuple.isChanged = false;
+  for (uint32_t i = 1; i <= 5; ++i)
+    {
+      tuple.nodeAddr = Ipv4Address (0x0a010100 + i);
+      tuple.xcoord = 10 * i;
+      geo.InsertGeographicTuple (tuple, needTriggerUpdate);
+    }
+  NS_TEST_EXPECT_MSG_EQ (geo.GetGeographicInfo ().size (), 5, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (needTriggerUpdate, false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (geo.FindGeographicTuple (Ipv4Address ("10.1.1.9")) == NULL, true, "trivial");
+  GeographicTuple *found = geo.FindGeographicTuple (Ipv4Address ("10.1.1.3"));
+  NS_TEST_ASSERT_MSG_NE (found, NULL, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (found->xcoord, 30, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (found->isChanged, true, "A new tuple is marked as changed");
+
+  tuple.nodeAddr = Ipv4Address ("10.1.1.3");
+  tuple.xcoord = 99;
+  tuple.xvelocity = 2;
+  geo.InsertGeographicTuple (tuple, needTriggerUpdate);
+  NS_TEST_EXPECT_MSG_EQ (needTriggerUpdate, true, "Velocity change triggers an update");
+  NS_TEST_EXPECT_MSG_EQ (geo.GetGeographicInfo ().size (), 5, "Update in place");
+  NS_TEST_EXPECT_MSG_EQ (geo.GetGeographicInfo ()[2].xcoord, 99, "Insertion order is kept");
+
+  geo.SetIsBeingUpdated (Ipv4Address ("10.1.1.4"), true);
+  NS_TEST_EXPECT_MSG_EQ (geo.GetIsBeingUpdated (Ipv4Address ("10.1.1.4")), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (geo.GetIsBeingUpdated (Ipv4Address ("10.1.1.5")), false, "trivial");
+  geo.UpdateTupleIsChanged (Ipv4Address ("10.1.1.4"), false);
+  NS_TEST_EXPECT_MSG_EQ (geo.FindGeographicTuple (Ipv4Address ("10.1.1.4"))->isChanged, false, "trivial");
+  geo.EraseGeographicTuple (tuple);
+  NS_TEST_EXPECT_MSG_EQ (geo.FindGeographicTuple (Ipv4Address ("10.1.1.3"))->xcoord, 9999, "Erased tuple is reset");
+}
+// -----------------------------------------------------------------------------
+// / Unit test for the spatial queries of the SiFT geographic set
+class SiftGeoGridTest : public TestCase
+{
+public:
+  SiftGeoGridTest ();
+  ~SiftGeoGridTest ();
+  virtual void
+  DoRun (void);
+};
+SiftGeoGridTest::SiftGeoGridTest ()
+  : TestCase ("SiFT geographic grid")
+{
+}
+SiftGeoGridTest::~SiftGeoGridTest ()
+{
+}
+void
+SiftGeoGridTest::DoRun ()
+{
+  SiftGeo geo;
+  geo.SetGridCellSize (100);
+  bool needTriggerUpdate = false;
+  GeographicTuple tuple;
+  tuple.zcoord = 0;
+  tuple.xvelocity = 0;
+  tuple.yvelocity = 0;
+  tuple.zvelocity = 0;
+  // Deterministic pseudo random positions in [-500, 1500) x [-500, 1500)
+  uint32_t seed = 12345;
+  for (uint32_t i = 0; i < 400; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      int32_t x = (seed >> 8) % 2000 - 500;
+      seed = seed * 1103515245 + 12345;
+      int32_t y = (seed >> 8) % 2000 - 500;
+      tuple.nodeAddr = Ipv4Address (0x0a000000 + i);
+      tuple.xcoord = x;
+      tuple.ycoord = y;
+      geo.InsertGeographicTuple (tuple, needTriggerUpdate);
+    }
+  // Move one node across cells
+  tuple.nodeAddr = Ipv4Address (0x0a000000);
+  tuple.xcoord = 250;
+  tuple.ycoord = 250;
+  geo.InsertGeographicTuple (tuple, needTriggerUpdate);
+
+  const GeographicSet &set = geo.GetGeographicInfo ();
+  std::vector<Ipv4Address> nodes;
+  geo.GetNodesInRadius (250, 250, 180, nodes);
+  uint32_t expected = 0;
+  for (GeographicSet::const_iterator it = set.begin (); it != set.end (); ++it)
+    {
+      double dx = (int32_t) it->xcoord - 250.0;
+      double dy = (int32_t) it->ycoord - 250.0;
+      if (std::sqrt (dx * dx + dy * dy) <= 180)
+        {
+          expected++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (nodes.size (), expected, "Radius query matches a full scan");
+  NS_TEST_EXPECT_MSG_EQ (std::find (nodes.begin (), nodes.end (), Ipv4Address (0x0a000000)) != nodes.end (), true,
+                         "Moved node is found in its new cell");
+
+  double segments[3][4] = { { -400, -300, 1300, 1100 }, { 0, 1200, 100, -400 }, { 300, 300, 300, 300 } };
+  for (uint32_t s = 0; s < 3; ++s)
+    {
+      double x1 = segments[s][0], y1 = segments[s][1], x2 = segments[s][2], y2 = segments[s][3];
+      geo.GetNodesNearSegment (x1, y1, x2, y2, 120, nodes);
+      expected = 0;
+      for (GeographicSet::const_iterator it = set.begin (); it != set.end (); ++it)
+        {
+          double px = (int32_t) it->xcoord, py = (int32_t) it->ycoord;
+          double dx = x2 - x1, dy = y2 - y1;
+          double t = (dx * dx + dy * dy) > 0 ? ((px - x1) * dx + (py - y1) * dy) / (dx * dx + dy * dy) : 0;
+          t = std::max (0.0, std::min (1.0, t));
+          double ex = x1 + t * dx - px, ey = y1 + t * dy - py;
+          if (std::sqrt (ex * ex + ey * ey) <= 120)
+            {
+              expected++;
+            }
+        }
+      NS_TEST_EXPECT_MSG_EQ (nodes.size (), expected, "Corridor query matches a full scan");
+    }
+
+  geo.EraseGeographicTuple (tuple);
+  geo.GetNodesInRadius (250, 250, 1, nodes);
+  NS_TEST_EXPECT_MSG_EQ (nodes.size (), 0, "Erased tuple leaves the grid");
+}
+// -----------------------------------------------------------------------------
+class SiftGeometryKernelTest : public TestCase
+{
+public:
+  SiftGeometryKernelTest ();
+  ~SiftGeometryKernelTest ();
+  virtual void
+  DoRun (void);
+};
+SiftGeometryKernelTest::SiftGeometryKernelTest ()
+  : TestCase ("SiFT batch distance kernels")
+{
+}
+SiftGeometryKernelTest::~SiftGeometryKernelTest ()
+{
+}
+void
+SiftGeometryKernelTest::DoRun ()
+{
+  SiftGeo geo;
+  bool needTriggerUpdate = false;
+  GeographicTuple tuple;
+  tuple.zcoord = 0;
+  tuple.zvelocity = 0;
+  // An odd count exercises the scalar tail after the vector loop
+  uint32_t seed = 54321;
+  for (uint32_t i = 0; i < 37; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      tuple.xcoord = (int32_t) ((seed >> 8) % 2000) - 500;
+      seed = seed * 1103515245 + 12345;
+      tuple.ycoord = (int32_t) ((seed >> 8) % 2000) - 500;
+      tuple.xvelocity = i % 7 - 3;
+      tuple.yvelocity = 3 - i % 5;
+      tuple.nodeAddr = Ipv4Address (0x0a000000 + i);
+      geo.InsertGeographicTuple (tuple, needTriggerUpdate);
+      if (i == 20)
+        {
+          NS_TEST_EXPECT_MSG_EQ (geo.GetXCoords ().size (), 0, "Arrays are not kept by default");
+          // Filled from the tuples already inserted, then kept up to date
+          geo.SetArraysEnabled (true);
+        }
+    }
+  const GeographicSet &set = geo.GetGeographicInfo ();
+  NS_TEST_ASSERT_MSG_EQ (geo.GetXCoords ().size (), set.size (), "One array entry per slot");
+  for (uint32_t i = 0; i < set.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (geo.GetXCoords ()[i], (int32_t) set[i].xcoord, "x array mirrors the tuple");
+      NS_TEST_EXPECT_MSG_EQ (geo.GetYCoords ()[i], (int32_t) set[i].ycoord, "y array mirrors the tuple");
+      NS_TEST_EXPECT_MSG_EQ (geo.GetXVelocities ()[i], set[i].xvelocity, "x velocity array mirrors the tuple");
+      NS_TEST_EXPECT_MSG_EQ (geo.GetYVelocities ()[i], set[i].yvelocity, "y velocity array mirrors the tuple");
+    }
+
+  std::vector<double> distances;
+  geo.GetDistancesToPoint (120, -40, distances);
+  NS_TEST_ASSERT_MSG_EQ (distances.size (), set.size (), "One distance per slot");
+  for (uint32_t i = 0; i < set.size (); ++i)
+    {
+      double dx = (int32_t) set[i].xcoord - 120.0, dy = (int32_t) set[i].ycoord + 40.0;
+      NS_TEST_EXPECT_MSG_EQ_TOL (distances[i], std::sqrt (dx * dx + dy * dy), 1e-9, "Distance to point");
+    }
+
+  double x1 = -300, y1 = 100, x2 = 900, y2 = 700;
+  geo.GetDistancesToTrajectory (x1, y1, x2, y2, distances);
+  for (uint32_t i = 0; i < set.size (); ++i)
+    {
+      double px = (int32_t) set[i].xcoord, py = (int32_t) set[i].ycoord;
+      double expected = std::fabs ((y2 - y1) * px - (x2 - x1) * py + x2 * y1 - y2 * x1)
+        / std::sqrt ((y2 - y1) * (y2 - y1) + (x2 - x1) * (x2 - x1));
+      double t = ((px - x1) * (x2 - x1) + (py - y1) * (y2 - y1)) / ((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+      if (t < 0)
+        {
+          expected = std::sqrt ((px - x1) * (px - x1) + (py - y1) * (py - y1));
+        }
+      else if (t > 1)
+        {
+          expected = std::sqrt ((px - x2) * (px - x2) + (py - y2) * (py - y2));
+        }
+      NS_TEST_EXPECT_MSG_EQ_TOL (distances[i], expected, 1e-9, "Distance to the segment of the trajectory");
+    }
+  // Vertical segment with a node beside it and one beyond its end, and a segment that is a single point
+  geo.GetDistancesToTrajectory ((int32_t) set[3].xcoord + 50.0, (int32_t) set[3].ycoord - 10.0,
+                                (int32_t) set[3].xcoord + 50.0, (int32_t) set[3].ycoord + 10.0, distances);
+  NS_TEST_EXPECT_MSG_EQ_TOL (distances[3], 50, 1e-9, "Vertical segment");
+  geo.GetDistancesToTrajectory ((int32_t) set[3].xcoord, (int32_t) set[3].ycoord + 30.0,
+                                (int32_t) set[3].xcoord, (int32_t) set[3].ycoord + 90.0, distances);
+  NS_TEST_EXPECT_MSG_EQ_TOL (distances[3], 30, 1e-9, "Beyond the start of the segment");
+  geo.GetDistancesToTrajectory (50, 60, 50, 60, distances);
+  double dx = (int32_t) set[5].xcoord - 50.0, dy = (int32_t) set[5].ycoord - 60.0;
+  NS_TEST_EXPECT_MSG_EQ_TOL (distances[5], std::sqrt (dx * dx + dy * dy), 1e-9, "Degenerate trajectory");
+
+  // Moving a node updates its array entries
+  tuple = set[0];
+  tuple.xcoord = 7;
+  tuple.ycoord = (uint32_t) -9;
+  geo.InsertGeographicTuple (tuple, needTriggerUpdate);
+  NS_TEST_EXPECT_MSG_EQ (geo.GetXCoords ()[0], 7, "Updated x coordinate");
+  NS_TEST_EXPECT_MSG_EQ (geo.GetYCoords ()[0], -9, "Updated y coordinate");
+}
+// -----------------------------------------------------------------------------
+class SiftGeoPredictionTest : public TestCase
+{
+public:
+  SiftGeoPredictionTest ();
+  ~SiftGeoPredictionTest ();
+  virtual void
+  DoRun (void);
+};
+SiftGeoPredictionTest::SiftGeoPredictionTest ()
+  : TestCase ("SiFT position prediction")
+{
+}
+SiftGeoPredictionTest::~SiftGeoPredictionTest ()
+{
+}
+void
+SiftGeoPredictionTest::DoRun ()
+{
+  SiftGeo geo;
+  bool needTriggerUpdate = false;
+  GeographicTuple tuple;
+  tuple.nodeAddr = Ipv4Address ("10.1.1.7");
+  tuple.xcoord = 100;
+  tuple.ycoord = (uint32_t) -50;
+  tuple.zcoord = 0;
+  tuple.xvelocity = 4;
+  tuple.yvelocity = -2;
+  tuple.zvelocity = 0;
+  tuple.recordedTime = Seconds (10);
+  tuple.expireTime = Seconds (1000);
+  geo.InsertGeographicTuple (tuple, needTriggerUpdate);
+
+  double x = 0, y = 0;
+  NS_TEST_EXPECT_MSG_EQ (geo.PredictPosition (Ipv4Address ("10.1.1.8"), Seconds (10), Seconds (5), x, y), false,
+                         "Unknown node has no prediction");
+  NS_TEST_ASSERT_MSG_EQ (geo.PredictPosition (tuple.nodeAddr, Seconds (10), Seconds (5), x, y), true,
+                         "Fresh record is used");
+  NS_TEST_EXPECT_MSG_EQ_TOL (x, 100, 1e-9, "No movement at the record time");
+  NS_TEST_EXPECT_MSG_EQ_TOL (y, -50, 1e-9, "No movement at the record time");
+  NS_TEST_ASSERT_MSG_EQ (geo.PredictPosition (tuple.nodeAddr, Seconds (12.5), Seconds (5), x, y), true,
+                         "Record within the staleness bound is used");
+  NS_TEST_EXPECT_MSG_EQ_TOL (x, 110, 1e-9, "Extrapolated x");
+  NS_TEST_EXPECT_MSG_EQ_TOL (y, -55, 1e-9, "Extrapolated y");
+  NS_TEST_EXPECT_MSG_EQ (geo.PredictPosition (tuple.nodeAddr, Seconds (15.5), Seconds (5), x, y), false,
+                         "Stale record is not used");
+
+  // A new record restarts the extrapolation
+  tuple.xcoord = 130;
+  tuple.ycoord = (uint32_t) -70;
+  tuple.xvelocity = 0;
+  tuple.recordedTime = Seconds (16);
+  geo.InsertGeographicTuple (tuple, needTriggerUpdate);
+  NS_TEST_ASSERT_MSG_EQ (geo.PredictPosition (tuple.nodeAddr, Seconds (18), Seconds (5), x, y), true,
+                         "Refreshed record is used");
+  NS_TEST_EXPECT_MSG_EQ_TOL (x, 130, 1e-9, "Extrapolated x after refresh");
+  NS_TEST_EXPECT_MSG_EQ_TOL (y, -74, 1e-9, "Extrapolated y after refresh");
+
+  geo.EraseGeographicTuple (tuple);
+  NS_TEST_EXPECT_MSG_EQ (geo.PredictPosition (tuple.nodeAddr, Seconds (18), Seconds (5), x, y), false,
+                         "Erased node has no prediction");
+}
+// -----------------------------------------------------------------------------
+class SiftNodeRegistryTest : public TestCase
+{
+public:
+  SiftNodeRegistryTest ();
+  ~SiftNodeRegistryTest ();
+  virtual void
+  DoRun (void);
+};
+SiftNodeRegistryTest::SiftNodeRegistryTest ()
+  : TestCase ("SiFT node registry")
+{
+}
+SiftNodeRegistryTest::~SiftNodeRegistryTest ()
+{
+}
+void
+SiftNodeRegistryTest::DoRun ()
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (devices);
+
+  // Built on the first lookup, after the addresses are assigned
+  Ptr<SiftNodeRegistry> registry = CreateObject<SiftNodeRegistry> ();
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("10.1.1.2")), nodes.Get (1), "Node of an address");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetInterface (Ipv4Address ("10.1.1.2")), 1, "Interface of an address");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("10.1.1.3")), nodes.Get (2), "Node of an address");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("10.1.1.9")), 0, "Unknown address");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetInterface (Ipv4Address ("10.1.1.9")), -1, "Unknown address");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("127.0.0.1")), 0, "Loopback is not registered");
+
+  // An address assigned later is found once the registry is rebuilt
+  Ptr<SimpleNetDevice> extra = CreateObject<SimpleNetDevice> ();
+  extra->SetAddress (Mac48Address::Allocate ());
+  nodes.Get (2)->AddDevice (extra);
+  address.SetBase ("10.2.0.0", "255.255.0.0");
+  address.Assign (NetDeviceContainer (extra));
+  registry->Rebuild ();
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("10.2.0.1")), nodes.Get (2), "Address of a second interface");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetInterface (Ipv4Address ("10.2.0.1")), 2, "Second interface");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetSize (), 4, "One entry per assigned address");
+
+  // More nodes than a /24 holds, on a /16
+  NodeContainer many;
+  many.Create (300);
+  internet.Install (many);
+  NetDeviceContainer manyDevices;
+  for (uint32_t i = 0; i < many.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      many.Get (i)->AddDevice (device);
+      manyDevices.Add (device);
+    }
+  address.SetBase ("10.3.0.0", "255.255.0.0");
+  address.Assign (manyDevices);
+  registry->Rebuild ();
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("10.3.1.44")), many.Get (299), "Node beyond the 256th");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("10.3.0.255")), many.Get (254), "Address ending in 255");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetSize (), 304, "One entry per assigned address");
+
+  // A removed address is not returned, without an explicit rebuild
+  Ptr<Ipv4> ipv4 = many.Get (299)->GetObject<Ipv4> ();
+  ipv4->RemoveAddress (1, 0);
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("10.3.1.44")), 0, "Removed address");
+  NS_TEST_EXPECT_MSG_EQ (registry->GetSize (), 303, "Table rebuilt without the removed address");
+  // Moved to another node
+  Ipv4InterfaceAddress moved (Ipv4Address ("10.3.1.44"), Ipv4Mask ("255.255.0.0"));
+  ipv4 = many.Get (0)->GetObject<Ipv4> ();
+  ipv4->AddAddress (1, moved);
+  registry->Rebuild ();
+  NS_TEST_EXPECT_MSG_EQ (registry->GetNode (Ipv4Address ("10.3.1.44")), many.Get (0), "Address found on its new node");
+
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+class SiftPositionOracleTest : public TestCase
+{
+public:
+  SiftPositionOracleTest ();
+  ~SiftPositionOracleTest ();
+  virtual void
+  DoRun (void);
+  void CheckPositions (Ptr<SiftPositionOracle> oracle);
+};
+SiftPositionOracleTest::SiftPositionOracleTest ()
+  : TestCase ("SiFT position oracle")
+{
+}
+SiftPositionOracleTest::~SiftPositionOracleTest ()
+{
+}
+void
+SiftPositionOracleTest::CheckPositions (Ptr<SiftPositionOracle> oracle)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (oracle->GetPosition (0).x, 10, 1e-9, "Position is read again at a later time");
+  NS_TEST_EXPECT_MSG_EQ_TOL (oracle->GetPosition (1).x, 30, 1e-9, "Position is read again at a later time");
+  NS_TEST_EXPECT_MSG_EQ_TOL (oracle->GetVelocity (1).x, 5, 1e-9, "Velocity of the node");
+}
+void
+SiftPositionOracleTest::DoRun ()
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<SiftPositionOracle> oracle = CreateObject<SiftPositionOracle> ();
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (20 * i, 0, 0));
+      mobility->SetVelocity (Vector (5, 0, 0));
+      nodes.Get (i)->AggregateObject (mobility);
+      oracle->AddNode (nodes.Get (i));
+    }
+  oracle->AddNode (nodes.Get (1));
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetNNodes (), 2, "A node is added once");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetIndex (nodes.Get (1)->GetId ()), 1, "Index of a node");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetIndex (nodes.Get (1)->GetId () + 1), -1, "Unknown node");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetNode (0), nodes.Get (0), "Node of an index");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetAddress (0), Ipv4Address (), "Node without an address");
+  NS_TEST_EXPECT_MSG_EQ_TOL (oracle->GetPosition (1).x, 20, 1e-9, "Position of the node");
+
+  Simulator::Schedule (Seconds (2), &SiftPositionOracleTest::CheckPositions, this, oracle);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+class SiftBeaconHeaderTest : public TestCase
+{
+public:
+  SiftBeaconHeaderTest ();
+  ~SiftBeaconHeaderTest ();
+  virtual void
+  DoRun (void);
+};
+SiftBeaconHeaderTest::SiftBeaconHeaderTest ()
+  : TestCase ("SiFT beacon header")
+{
+}
+SiftBeaconHeaderTest::~SiftBeaconHeaderTest ()
+{
+}
+void
+SiftBeaconHeaderTest::DoRun ()
+{
+  SiftBeaconHeader beacon;
+  SiftBeaconEntry entry;
+  entry.address = Ipv4Address ("10.1.0.5");
+  entry.xLoc = -1200;
+  entry.yLoc = 70000;
+  entry.xVelocity = -13;
+  entry.yVelocity = 25;
+  entry.age = 0;
+  beacon.AddEntry (entry);
+  entry.address = Ipv4Address ("10.1.3.9");
+  entry.xLoc = 15;
+  entry.yLoc = -4;
+  entry.xVelocity = 0;
+  entry.yVelocity = -1;
+  entry.age = 65535;
+  beacon.AddEntry (entry);
+  NS_TEST_EXPECT_MSG_EQ (beacon.GetSerializedSize (), 4 + 2 * 18, "Size of a beacon with two entries");
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (beacon);
+  NS_TEST_EXPECT_MSG_EQ (SiftBeaconHeader::IsBeacon (packet), true, "Beacon is recognized");
+  SiftBeaconHeader received;
+  packet->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 0, "Whole beacon is read");
+  const std::vector<SiftBeaconEntry> &entries = received.GetEntries ();
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 2, "Entries survive serialization");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].address, Ipv4Address ("10.1.0.5"), "Address");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].xLoc, -1200, "Negative coordinate");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].yLoc, 70000, "Coordinate beyond 16 bits");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].xVelocity, -13, "Negative velocity");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].yVelocity, 25, "Velocity");
+  NS_TEST_EXPECT_MSG_EQ (entries[1].address, Ipv4Address ("10.1.3.9"), "Address of the second entry");
+  NS_TEST_EXPECT_MSG_EQ (entries[1].yVelocity, -1, "Velocity of the second entry");
+  NS_TEST_EXPECT_MSG_EQ (entries[1].age, 65535, "Age of the second entry");
+
+  // A data packet is not a beacon
+  SiftHeader data;
+  packet = Create<Packet> ();
+  packet->AddHeader (data);
+  NS_TEST_EXPECT_MSG_EQ (SiftBeaconHeader::IsBeacon (packet), false, "Data packet is not a beacon");
+  NS_TEST_EXPECT_MSG_EQ (SiftBeaconHeader::IsBeacon (Create<Packet> ()), false, "Empty packet is not a beacon");
+}
+// -----------------------------------------------------------------------------
+class SiftCompactHeaderTest : public TestCase
+{
+public:
+  SiftCompactHeaderTest ();
+  ~SiftCompactHeaderTest ();
+  virtual void
+  DoRun (void);
+private:
+  /// Serialize a header into a packet, peek its key and read it back
+  SiftHeader RoundTrip (const SiftHeader &header, uint32_t expectedSize);
+};
+SiftCompactHeaderTest::SiftCompactHeaderTest ()
+  : TestCase ("SiFT compact header format")
+{
+}
+SiftCompactHeaderTest::~SiftCompactHeaderTest ()
+{
+}
+SiftHeader
+SiftCompactHeaderTest::RoundTrip (const SiftHeader &header, uint32_t expectedSize)
+{
+  NS_TEST_EXPECT_MSG_EQ (header.GetSerializedSize (), expectedSize, "Serialized size");
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  SiftKeyHeader key;
+  NS_TEST_EXPECT_MSG_EQ (packet->PeekHeader (key), expectedSize, "Peeked key spans the whole header");
+  NS_TEST_EXPECT_MSG_EQ (key.GetSourceAddress (), header.GetSourceAddress (), "Peeked source address");
+  NS_TEST_EXPECT_MSG_EQ (key.GetDestAddress (), header.GetDestAddress (), "Peeked destination address");
+  NS_TEST_EXPECT_MSG_EQ (key.GetHeaderSeqNo (), header.GetHeaderSeqNo (), "Peeked sequence number");
+  SiftHeader received;
+  packet->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 0, "Whole header is read");
+  NS_TEST_EXPECT_MSG_EQ (received.IsCompact (), header.IsCompact (), "Format");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)received.GetNextHeader (), (uint32_t)header.GetNextHeader (), "Next header");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)received.GetMessageType (), (uint32_t)header.GetMessageType (), "Message type");
+  NS_TEST_EXPECT_MSG_EQ (received.GetSourceAddress (), header.GetSourceAddress (), "Source address");
+  NS_TEST_EXPECT_MSG_EQ (received.GetDestAddress (), header.GetDestAddress (), "Destination address");
+  NS_TEST_EXPECT_MSG_EQ (received.GetSourceXLoc (), header.GetSourceXLoc (), "Source x");
+  NS_TEST_EXPECT_MSG_EQ (received.GetSourceYLoc (), header.GetSourceYLoc (), "Source y");
+  NS_TEST_EXPECT_MSG_EQ (received.GetLastSourceXLoc (), header.GetLastSourceXLoc (), "Last source x");
+  NS_TEST_EXPECT_MSG_EQ (received.GetLastSourceYLoc (), header.GetLastSourceYLoc (), "Last source y");
+  NS_TEST_EXPECT_MSG_EQ (received.GetDestXLoc (), header.GetDestXLoc (), "Destination x");
+  NS_TEST_EXPECT_MSG_EQ (received.GetDestYLoc (), header.GetDestYLoc (), "Destination y");
+  NS_TEST_EXPECT_MSG_EQ (received.GetHeaderSeqNo (), header.GetHeaderSeqNo (), "Sequence number");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)received.GetHeaderTTL (), (uint32_t)header.GetHeaderTTL (), "TTL");
+  return received;
+}
+void
+SiftCompactHeaderTest::DoRun ()
+{
+  SiftHeader header;
+  header.SetNextHeader (17);
+  header.SetMessageType (47);
+  header.SetSourceAddress (Ipv4Address ("10.1.0.1"));
+  header.SetDestAddress (Ipv4Address ("10.1.2.3"));
+  header.SetSourceXLoc (0);
+  header.SetSourceYLoc (150);
+  header.SetLastSourceXLoc (-300);
+  header.SetLastSourceYLoc (32767);
+  header.SetDestXLoc (1200);
+  header.SetDestYLoc (-32768);
+  header.SetHeaderSeqNo (65000);
+  header.SetHeaderTTL (63);
+  RoundTrip (header, 48);
+
+  header.SetCompact (true);
+  RoundTrip (header, 26);
+
+  // A coordinate beyond 16 bits falls back to 32-bit coordinates
+  header.SetDestYLoc (70000);
+  RoundTrip (header, 38);
+  header.SetLastSourceXLoc (-40000);
+  RoundTrip (header, 38);
+  header.SetLastSourceXLoc (-300);
+
+  // Coordinates off a coarser grid do too, the ones on it fit again
+  SiftHeader::SetCompactGrid (1000, -1000, 10);
+  RoundTrip (header, 38);
+  header.SetSourceYLoc (160);
+  header.SetLastSourceXLoc (-310);
+  header.SetLastSourceYLoc (32760);
+  header.SetDestYLoc (-300000);
+  RoundTrip (header, 26);
+  SiftHeader::SetCompactGrid (0, 0, 1);
+
+  // Compact headers are not mistaken for beacons
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (SiftBeaconHeader::IsBeacon (packet), false, "Compact packet is not a beacon");
+}
+// -----------------------------------------------------------------------------
+class SiftWaypointTest : public TestCase
+{
+public:
+  SiftWaypointTest ();
+  ~SiftWaypointTest ();
+  virtual void
+  DoRun (void);
+};
+SiftWaypointTest::SiftWaypointTest ()
+  : TestCase ("SiFT trajectory waypoints")
+{
+}
+SiftWaypointTest::~SiftWaypointTest ()
+{
+}
+void
+SiftWaypointTest::DoRun ()
+{
+  SiftHeader header;
+  header.SetSourceAddress (Ipv4Address ("10.1.0.1"));
+  header.SetDestAddress (Ipv4Address ("10.1.0.2"));
+  header.SetSourceXLoc (0);
+  header.SetSourceYLoc (0);
+  header.SetDestXLoc (500);
+  header.SetDestYLoc (800);
+  header.SetHeaderSeqNo (7);
+  std::vector<SiftWaypoint> waypoints (2);
+  waypoints[0].x = 500;
+  waypoints[0].y = 0;
+  waypoints[1].x = 500;
+  waypoints[1].y = -70000;
+  header.SetWaypoints (waypoints);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)header.GetSegmentsLeft (), 3, "Three segments left");
+
+  int32_t x1, y1, x2, y2;
+  header.GetActiveSegment (x1, y1, x2, y2);
+  NS_TEST_EXPECT_MSG_EQ (x1, 0, "First segment starts at the source");
+  NS_TEST_EXPECT_MSG_EQ (x2, 500, "First segment ends at the first waypoint");
+  NS_TEST_EXPECT_MSG_EQ (y2, 0, "First segment ends at the first waypoint");
+  header.SetSegmentsLeft (1);
+  header.GetActiveSegment (x1, y1, x2, y2);
+  NS_TEST_EXPECT_MSG_EQ (y1, -70000, "Last segment starts at the last waypoint");
+  NS_TEST_EXPECT_MSG_EQ (y2, 800, "Last segment ends at the destination");
+  header.SetSegmentsLeft (2);
+
+  // Past the end of a segment, the progress is above one
+  NS_TEST_EXPECT_MSG_EQ_TOL (SegmentProgress (250, 40, 0, 0, 500, 0), 0.5, 1e-9, "Halfway");
+  NS_TEST_EXPECT_MSG_EQ (SegmentProgress (510, 40, 0, 0, 500, 0) > 1, true, "Past the end");
+  NS_TEST_EXPECT_MSG_EQ (SegmentProgress (-10, 40, 0, 0, 500, 0) < 0, true, "Before the start");
+  NS_TEST_EXPECT_MSG_EQ (SegmentProgress (3, 4, 3, 4, 3, 4), 1, "Segment without length");
+
+  // The corridor around a segment is closed by half discs at its ends
+  NS_TEST_EXPECT_MSG_EQ_TOL (DistanceToSegment (250, 40, 0, 0, 500, 0), 40, 1e-9, "Beside the segment");
+  NS_TEST_EXPECT_MSG_EQ_TOL (DistanceToSegment (530, 40, 0, 0, 500, 0), 50, 1e-9, "Beyond its end");
+  NS_TEST_EXPECT_MSG_EQ_TOL (DistanceToSegment (-3, -4, 0, 0, 500, 0), 5, 1e-9, "Behind its start");
+  NS_TEST_EXPECT_MSG_EQ_TOL (DistanceToSegment (6, 8, 0, 0, 0, 0), 10, 1e-9, "Segment without length");
+
+  // Waypoints survive both formats and the key can still be peeked
+  uint32_t sizes[] = { 48 + 2 * 8, 38 + 2 + 2 * 8 };
+  for (uint32_t format = 0; format < 2; ++format)
+    {
+      header.SetCompact (format == 1);
+      NS_TEST_EXPECT_MSG_EQ (header.GetSerializedSize (), sizes[format], "Serialized size");
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (header);
+      SiftKeyHeader key;
+      NS_TEST_EXPECT_MSG_EQ (packet->PeekHeader (key), sizes[format], "Peeked key spans the whole header");
+      NS_TEST_EXPECT_MSG_EQ (key.GetHeaderSeqNo (), 7, "Peeked sequence number");
+      SiftHeader received;
+      packet->RemoveHeader (received);
+      NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 0, "Whole header is read");
+      NS_TEST_ASSERT_MSG_EQ (received.GetWaypoints ().size (), 2, "Waypoints");
+      NS_TEST_EXPECT_MSG_EQ (received.GetWaypoints ()[1].y, -70000, "Waypoint coordinate");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)received.GetSegmentsLeft (), 2, "Segments left");
+      NS_TEST_EXPECT_MSG_EQ (received.GetDestYLoc (), 800, "Destination after the waypoints");
+    }
+
+  // On the compact grid the waypoints take 16-bit offsets too
+  waypoints[1].y = -700;
+  header.SetWaypoints (waypoints);
+  NS_TEST_EXPECT_MSG_EQ (header.GetSerializedSize (), 26 + 2 + 2 * 4, "Compact size with waypoints");
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  SiftHeader received;
+  packet->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (received.GetWaypoints ()[1].y, -700, "Compact waypoint coordinate");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)received.GetSegmentsLeft (), 3, "Segments left reset by SetWaypoints");
+}
+// -----------------------------------------------------------------------------
+class SiftRoadMapTest : public TestCase
+{
+public:
+  SiftRoadMapTest ();
+  ~SiftRoadMapTest ();
+  virtual void
+  DoRun (void);
+};
+SiftRoadMapTest::SiftRoadMapTest ()
+  : TestCase ("SiFT road map planner")
+{
+}
+SiftRoadMapTest::~SiftRoadMapTest ()
+{
+}
+void
+SiftRoadMapTest::DoRun ()
+{
+  Ptr<SiftRoadMap> map = CreateObject<SiftRoadMap> ();
+  NS_TEST_EXPECT_MSG_EQ (map->GetWaypoints (Vector (10, 10, 0), Vector (990, 990, 0)).size (), 0,
+                         "No roads, straight trajectory");
+
+  // An L shaped road and a longer detour through (0, 1000)
+  map->AddRoad (Vector (0, 0, 0), Vector (1000, 0, 0));
+  map->AddRoad (Vector (1000, 0, 0), Vector (1000, 1000, 0));
+  map->AddRoad (Vector (0, 0, 0), Vector (0, 1000, 0));
+  map->AddRoad (Vector (0, 1000, 0), Vector (500, 1200, 0));
+  map->AddRoad (Vector (500, 1200, 0), Vector (1000, 1000, 0.4));
+  NS_TEST_EXPECT_MSG_EQ (map->GetNIntersections (), 5, "Intersections are shared by their roads");
+
+  std::vector<SiftWaypoint> waypoints = map->GetWaypoints (Vector (10, 10, 0), Vector (990, 990, 0));
+  NS_TEST_ASSERT_MSG_EQ (waypoints.size (), 3, "Shortest path over three intersections");
+  NS_TEST_EXPECT_MSG_EQ (waypoints[0].x, 0, "Starts at the intersection near the source");
+  NS_TEST_EXPECT_MSG_EQ (waypoints[1].x, 1000, "Follows the L");
+  NS_TEST_EXPECT_MSG_EQ (waypoints[1].y, 0, "Follows the L");
+  NS_TEST_EXPECT_MSG_EQ (waypoints[2].y, 1000, "Ends at the intersection near the destination");
+  NS_TEST_EXPECT_MSG_EQ (map->GetNCachedRoutes (), 1, "Route is cached");
+
+  // Other positions in the same cells reuse the cached route
+  waypoints = map->GetWaypoints (Vector (200, 100, 0), Vector (760, 800, 0));
+  NS_TEST_EXPECT_MSG_EQ (waypoints.size (), 3, "Cached route");
+  NS_TEST_EXPECT_MSG_EQ (map->GetNCachedRoutes (), 1, "No new route");
+  waypoints = map->GetWaypoints (Vector (990, 990, 0), Vector (10, 10, 0));
+  NS_TEST_ASSERT_MSG_EQ (waypoints.size (), 3, "Reverse route");
+  NS_TEST_EXPECT_MSG_EQ (waypoints[0].y, 1000, "Reverse route starts near its source");
+  NS_TEST_EXPECT_MSG_EQ (map->GetNCachedRoutes (), 2, "Each direction is cached");
+  NS_TEST_EXPECT_MSG_EQ (map->GetWaypoints (Vector (10, 10, 0), Vector (200, 20, 0)).size (), 0,
+                         "Same cell, straight trajectory");
+
+  // A road that is not connected to the others
+  map->AddRoad (Vector (5000, 5000, 0), Vector (5100, 5000, 0));
+  NS_TEST_EXPECT_MSG_EQ (map->GetNCachedRoutes (), 0, "New roads clear the cache");
+  NS_TEST_EXPECT_MSG_EQ (map->GetWaypoints (Vector (10, 10, 0), Vector (5090, 5010, 0)).size (), 0,
+                         "No path, straight trajectory");
+  map->Dispose ();
+
+  // A boulevard with a crossing every 250 m only keeps the intersections where the path turns
+  Ptr<SiftRoadMap> boulevard = CreateObject<SiftRoadMap> ();
+  boulevard->SetMaxCachedRoutes (1);
+  for (int32_t x = 0; x < 2000; x += 250)
+    {
+      boulevard->AddRoad (Vector (x, 0, 0), Vector (x + 250, 0, 0));
+      boulevard->AddRoad (Vector (x, 0, 0), Vector (x, -250, 0));
+    }
+  boulevard->AddRoad (Vector (2000, 0, 0), Vector (2000, 1000, 0));
+  waypoints = boulevard->GetWaypoints (Vector (10, 10, 0), Vector (1990, 990, 0));
+  NS_TEST_ASSERT_MSG_EQ (waypoints.size (), 3, "Straight runs are merged");
+  NS_TEST_EXPECT_MSG_EQ (waypoints[1].x, 2000, "The turn is kept");
+  NS_TEST_EXPECT_MSG_EQ (waypoints[1].y, 0, "The turn is kept");
+  boulevard->GetWaypoints (Vector (1990, 990, 0), Vector (10, 10, 0));
+  NS_TEST_EXPECT_MSG_EQ (boulevard->GetNCachedRoutes (), 1, "Cache bounded by MaxCachedRoutes");
+  boulevard->Dispose ();
+
+  // Points on the way are dropped, turns and U-turns are kept
+  const int32_t points[][2] = { { 0, 0 }, { 100, 0 }, { 100, 0 }, { 300, 0 }, { 300, 200 }, { 300, 100 }, { 300, 50 }, { 0, 50 } };
+  std::vector<SiftWaypoint> trajectory;
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      SiftWaypoint point = { points[i][0], points[i][1] };
+      trajectory.push_back (point);
+    }
+  SimplifyTrajectory (trajectory);
+  NS_TEST_ASSERT_MSG_EQ (trajectory.size (), 5, "Points on the way are dropped");
+  NS_TEST_EXPECT_MSG_EQ (trajectory[1].x, 300, "Turn");
+  NS_TEST_EXPECT_MSG_EQ (trajectory[2].y, 200, "U-turn");
+  NS_TEST_EXPECT_MSG_EQ (trajectory[3].y, 50, "Turn after the U-turn");
+  NS_TEST_EXPECT_MSG_EQ (trajectory[4].x, 0, "Last point kept");
+}
+// -----------------------------------------------------------------------------
+class SiftDelayPolicyTest : public TestCase
+{
+public:
+  SiftDelayPolicyTest ();
+  ~SiftDelayPolicyTest ();
+  virtual void
+  DoRun (void);
+};
+SiftDelayPolicyTest::SiftDelayPolicyTest ()
+  : TestCase ("SiFT contention delay policies")
+{
+}
+SiftDelayPolicyTest::~SiftDelayPolicyTest ()
+{
+}
+void
+SiftDelayPolicyTest::DoRun ()
+{
+  SiftDelayContext context;
+  context.dTrajectory = 20;
+  context.dLastSource = 200;
+  context.progress = 150;
+  context.range = 250;
+  context.neighbors = 16;
+  context.referenceNeighbors = 8;
+  context.minScale = 0.25;
+  context.maxScale = 4;
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (TrajectoryRatioDelay ().GetWeight (context), 0.1, 1e-12, "SiFT formula");
+  NS_TEST_EXPECT_MSG_EQ_TOL (TrajectoryRatioDelay ().GetDelay (context, 0.000047, 0.01), 0.001047, 1e-12,
+                             "Transmission time plus alpha times the weight");
+  NS_TEST_EXPECT_MSG_EQ_TOL (ProgressDelay ().GetWeight (context), 0.4, 1e-12, "Advance of 3/5 of the range");
+  NS_TEST_EXPECT_MSG_EQ_TOL (DistanceOnlyDelay ().GetWeight (context), 0.08, 1e-12, "Distance over the range");
+  NS_TEST_EXPECT_MSG_EQ_TOL (DensityAdaptiveDelay ().GetWeight (context), 0.2, 1e-12, "Twice the reference density");
+  context.neighbors = 8;
+  NS_TEST_EXPECT_MSG_EQ_TOL (DensityAdaptiveDelay ().GetWeight (context), TrajectoryRatioDelay ().GetWeight (context),
+                             1e-12, "Same as the ratio at the reference density");
+  context.neighbors = 0;
+  NS_TEST_EXPECT_MSG_EQ_TOL (DensityAdaptiveDelay ().GetWeight (context), 0.025, 1e-12, "Bounded below");
+  context.neighbors = 100;
+  NS_TEST_EXPECT_MSG_EQ_TOL (DensityAdaptiveDelay ().GetWeight (context), 0.4, 1e-12, "Bounded above");
+
+  // Degenerate positions give finite weights
+  context.dTrajectory = 0;
+  context.dLastSource = 0;
+  context.progress = -50;
+  NS_TEST_EXPECT_MSG_EQ_TOL (TrajectoryRatioDelay ().GetWeight (context), 1, 1e-12, "Relay at the last sender");
+  NS_TEST_EXPECT_MSG_EQ_TOL (ProgressDelay ().GetWeight (context), 1, 1e-12, "Relay behind the last sender");
+  NS_TEST_EXPECT_MSG_EQ_TOL (DistanceOnlyDelay ().GetWeight (context), 0, 1e-12, "Relay on the trajectory");
+  context.dTrajectory = 400;
+  context.progress = 400;
+  NS_TEST_EXPECT_MSG_EQ_TOL (ProgressDelay ().GetWeight (context), 0, 1e-12, "Advance beyond the range");
+  NS_TEST_EXPECT_MSG_EQ_TOL (DistanceOnlyDelay ().GetWeight (context), 1, 1e-12, "Beyond the range");
+}
+// -----------------------------------------------------------------------------
+class SiftSegmentDistanceTest : public TestCase
+{
+public:
+  SiftSegmentDistanceTest ();
+  ~SiftSegmentDistanceTest ();
+  virtual void
+  DoRun (void);
+};
+SiftSegmentDistanceTest::SiftSegmentDistanceTest ()
+  : TestCase ("SiFT point to segment distance properties")
+{
+}
+SiftSegmentDistanceTest::~SiftSegmentDistanceTest ()
+{
+}
+void
+SiftSegmentDistanceTest::DoRun ()
+{
+  // Random points around random segments, a tenth of them without length
+  uint32_t seed = 24680;
+  std::vector<double> x, y, distances, progress;
+  for (uint32_t s = 0; s < 50; ++s)
+    {
+      int32_t c[6];
+      for (uint32_t k = 0; k < 6; ++k)
+        {
+          seed = seed * 1103515245 + 12345;
+          c[k] = (int32_t) ((seed >> 8) % 4000) - 2000;
+        }
+      if (s % 10 == 0)
+        {
+          c[4] = c[2];
+          c[5] = c[3];
+        }
+      int32_t px = c[0], py = c[1], x1 = c[2], y1 = c[3], x2 = c[4], y2 = c[5];
+      double d = DistanceToSegment ((double) px, (double) py, (double) x1, (double) y1, (double) x2, (double) y2);
+      double t = SegmentProgress ((double) px, (double) py, (double) x1, (double) y1, (double) x2, (double) y2);
+      double dStart = std::sqrt (std::pow (px - x1, 2.0) + std::pow (py - y1, 2.0));
+      double dEnd = std::sqrt (std::pow (px - x2, 2.0) + std::pow (py - y2, 2.0));
+
+      NS_TEST_EXPECT_MSG_EQ (d == d && t == t, true, "No NaN, even without length");
+      NS_TEST_EXPECT_MSG_EQ (d <= std::min (dStart, dEnd) + 1e-9, true, "No farther than the nearest end point");
+      NS_TEST_EXPECT_MSG_EQ_TOL (DistanceToSegment ((double) px, (double) py, (double) x2, (double) y2, (double) x1, (double) y1),
+                                 d, 1e-9, "Direction of the segment does not matter");
+      NS_TEST_EXPECT_MSG_EQ_TOL (DistanceToSegment (px + 100.5, py - 40.5, x1 + 100.5, y1 - 40.5, x2 + 100.5, y2 - 40.5),
+                                 d, 1e-9, "Translation does not matter");
+      if (t <= 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (d, dStart, 1e-9, "Behind the start");
+        }
+      else if (t >= 1)
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (d, dEnd, 1e-9, "Beyond the end");
+        }
+      else
+        {
+          double line = std::fabs ((double) (y2 - y1) * px - (double) (x2 - x1) * py + (double) x2 * y1 - (double) y2 * x1)
+            / std::sqrt (std::pow (x2 - x1, 2.0) + std::pow (y2 - y1, 2.0));
+          NS_TEST_EXPECT_MSG_EQ_TOL (d, line, 1e-9, "Beside the segment, distance from its line");
+        }
+      NS_TEST_EXPECT_MSG_EQ_TOL (DistanceToSegment (px, py, x1, y1, x2, y2), d, 1e-9, "Integer coordinates");
+      NS_TEST_EXPECT_MSG_EQ_TOL (SegmentProgress (px, py, x1, y1, x2, y2), t, 1e-9, "Integer coordinates");
+      NS_TEST_EXPECT_MSG_EQ_TOL (DistanceToSegment ((float) px, (float) py, (float) x1, (float) y1, (float) x2, (float) y2),
+                                 d, 1e-2, "Single precision");
+      x.push_back (px);
+      y.push_back (py);
+      distances.resize (x.size ());
+      progress.resize (x.size ());
+      BatchDistanceToSegment (&x[0], &y[0], x.size (), x1, y1, x2, y2, &distances[0]);
+      BatchSegmentProgress (&x[0], &y[0], x.size (), x1, y1, x2, y2, &progress[0]);
+      for (uint32_t i = 0; i < x.size (); ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (distances[i], DistanceToSegment (x[i], y[i], (double) x1, (double) y1, (double) x2, (double) y2),
+                                     1e-9, "Batch distance, vector loop and scalar tail");
+          NS_TEST_EXPECT_MSG_EQ_TOL (progress[i], SegmentProgress (x[i], y[i], (double) x1, (double) y1, (double) x2, (double) y2),
+                                     1e-9, "Batch progress, vector loop and scalar tail");
+        }
+    }
+
+  // Source == destination and points on the segment are exact with integer coordinates
+  NS_TEST_EXPECT_MSG_EQ (DistanceToSegment (3, 4, 0, 0, 0, 0), 5, "Segment without length");
+  NS_TEST_EXPECT_MSG_EQ (SegmentProgress (3, 4, 0, 0, 0, 0), 1, "Segment without length");
+  NS_TEST_EXPECT_MSG_EQ (DistanceToSegment (70, 30, -70, -30, 140, 60), 0, "On the segment");
+  NS_TEST_EXPECT_MSG_EQ (DistanceToSegment (1 << 29, 1 << 29, -(1 << 29), -(1 << 29), 1 << 29, 1 << 29), 0,
+                         "Large coordinates do not overflow");
+  x.assign (3, 6);
+  y.assign (3, 8);
+  distances.assign (3, -1);
+  progress.assign (3, -1);
+  BatchDistanceToSegment (&x[0], &y[0], 3, 0, 0, 0, 0, &distances[0]);
+  BatchSegmentProgress (&x[0], &y[0], 3, 0, 0, 0, 0, &progress[0]);
+  NS_TEST_EXPECT_MSG_EQ (distances[2], 10, "Batch segment without length");
+  NS_TEST_EXPECT_MSG_EQ (progress[2], 1, "Batch segment without length");
+
+  NS_TEST_EXPECT_MSG_EQ (DistanceToPoint (3, 4, 0, 0), 5, "Distance between two points");
+  NS_TEST_EXPECT_MSG_EQ (DistanceToPoint (-(1 << 29), 0, 1 << 29, 0), 1 << 30, "Large coordinates do not overflow");
+}
+// -----------------------------------------------------------------------------
+class SiftTimerCollisionTest : public TestCase
+{
+public:
+  SiftTimerCollisionTest ();
+  ~SiftTimerCollisionTest ();
+  virtual void
+  DoRun (void);
+  void Collision (Ptr<const Packet> packet);
+  uint32_t m_collisions; ///< number of times the TimerCollision trace fired
+};
+SiftTimerCollisionTest::SiftTimerCollisionTest ()
+  : TestCase ("SiFT contention timer jitter and collisions"),
+    m_collisions (0)
+{
+}
+SiftTimerCollisionTest::~SiftTimerCollisionTest ()
+{
+}
+void
+SiftTimerCollisionTest::Collision (Ptr<const Packet> packet)
+{
+  m_collisions++;
+}
+void
+SiftTimerCollisionTest::DoRun ()
+{
+  // The same stream gives the same jitter, within MaxJitter
+  Ptr<SiftRouting> first = CreateObject<SiftRouting> ();
+  Ptr<SiftRouting> second = CreateObject<SiftRouting> ();
+  Ptr<SiftRouting> other = CreateObject<SiftRouting> ();
+  first->SetAttribute ("MaxJitter", TimeValue (MicroSeconds (500)));
+  second->SetAttribute ("MaxJitter", TimeValue (MicroSeconds (500)));
+  other->SetAttribute ("MaxJitter", TimeValue (MicroSeconds (500)));
+  NS_TEST_EXPECT_MSG_EQ (first->AssignStreams (7), 1, "One stream per agent");
+  second->AssignStreams (7);
+  other->AssignStreams (8);
+  bool differs = false;
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      Time jitter = first->GetJitter ();
+      NS_TEST_EXPECT_MSG_EQ (jitter, second->GetJitter (), "Same stream, same draws");
+      NS_TEST_EXPECT_MSG_EQ ((jitter >= Seconds (0) && jitter <= MicroSeconds (500)), true, "Jitter within MaxJitter");
+      differs = differs || jitter != other->GetJitter ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (differs, true, "Another stream gives other draws");
+  first->SetAttribute ("MaxJitter", TimeValue (Seconds (0)));
+  NS_TEST_EXPECT_MSG_EQ (first->GetJitter (), Seconds (0), "No jitter by default");
+
+  // Two relays at the same distance from the trajectory and from the source set the same
+  // timer, forward together and hear the copy of each other
+  NodeContainer nodes;
+  nodes.Create (4);
+  const double x[] = { 0, 200, 200, 400 };
+  const double y[] = { 0, 50, -50, 0 };
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (x[i], y[i], 0));
+      nodes.Get (i)->AggregateObject (mobility);
+    }
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SiftHelper sift;
+  sift.SetNodes (nodes);
+  SiftMainHelper siftMain;
+  siftMain.Install (sift, nodes);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  for (uint32_t i = 1; i <= 2; ++i)
+    {
+      nodes.Get (i)->GetObject<SiftRouting> ()->TraceConnectWithoutContext (
+        "TimerCollision", MakeCallback (&SiftTimerCollisionTest::Collision, this));
+    }
+
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (9);
+  udpHeader.SetDestinationPort (9);
+  packet->AddHeader (udpHeader);
+  Simulator::Schedule (Seconds (1), &SiftRouting::Send, nodes.Get (0)->GetObject<SiftRouting> (), packet,
+                       interfaces.GetAddress (0), interfaces.GetAddress (3), 17, Ptr<Ipv4Route> ());
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_collisions, 2, "Both tied relays report the collision");
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+class SiftRelayDropTest : public TestCase
+{
+public:
+  SiftRelayDropTest ();
+  ~SiftRelayDropTest ();
+  virtual void
+  DoRun (void);
+  void HopLimitDrops (uint32_t oldValue, uint32_t newValue);
+  void Drop (Ptr<const Packet> packet, SiftRouting::DropReason reason);
+  void Tx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * \brief Hand the relay a packet sent by node 0 towards node 2.
+   * \param seqNo sequence number of the packet
+   * \param ttl TTL of its SiFT header
+   * \param y ordinate of the source and the destination, 0 puts the relay on the trajectory
+   */
+  void ReceiveAtRelay (uint16_t seqNo, uint8_t ttl, int32_t y);
+  Ipv4InterfaceContainer m_interfaces; ///< addresses of the source, the relay and the destination
+  Ptr<SiftRouting> m_relay;            ///< the agent of the relay
+  uint32_t m_hopLimitDrops;            ///< last value of the HopLimitDrops trace of the relay
+  uint32_t m_ttlDrops;                 ///< number of DROP_TTL_EXPIRED reported by the relay
+  uint32_t m_corridorDrops;            ///< number of DROP_OFF_CORRIDOR reported by the relay
+  uint32_t m_tx;                       ///< number of packets sent by the relay
+};
+SiftRelayDropTest::SiftRelayDropTest ()
+  : TestCase ("SiFT TTL and corridor drops at relays"),
+    m_hopLimitDrops (0),
+    m_ttlDrops (0),
+    m_corridorDrops (0),
+    m_tx (0)
+{
+}
+SiftRelayDropTest::~SiftRelayDropTest ()
+{
+}
+void
+SiftRelayDropTest::HopLimitDrops (uint32_t oldValue, uint32_t newValue)
+{
+  m_hopLimitDrops = newValue;
+}
+void
+SiftRelayDropTest::Drop (Ptr<const Packet> packet, SiftRouting::DropReason reason)
+{
+  if (reason == SiftRouting::DROP_TTL_EXPIRED)
+    {
+      m_ttlDrops++;
+    }
+  else if (reason == SiftRouting::DROP_OFF_CORRIDOR)
+    {
+      m_corridorDrops++;
+    }
+}
+void
+SiftRelayDropTest::Tx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_tx++;
+}
+void
+SiftRelayDropTest::ReceiveAtRelay (uint16_t seqNo, uint8_t ttl, int32_t y)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udpHeader;
+  packet->AddHeader (udpHeader);
+  SiftHeader header;
+  header.SetNextHeader (17);
+  header.SetMessageType (47);
+  header.SetSourceAddress (m_interfaces.GetAddress (0));
+  header.SetDestAddress (m_interfaces.GetAddress (2));
+  header.SetSourceXLoc (0);
+  header.SetSourceYLoc (y);
+  header.SetLastSourceXLoc (0);
+  header.SetLastSourceYLoc (y);
+  header.SetDestXLoc (400);
+  header.SetDestYLoc (y);
+  header.SetHeaderSeqNo (seqNo);
+  header.SetHeaderTTL (ttl);
+  packet->AddHeader (header);
+  Ipv4Header ip;
+  ip.SetSource (m_interfaces.GetAddress (0));
+  ip.SetDestination (Ipv4Address::GetBroadcast ());
+  ip.SetProtocol (SiftRouting::PROT_NUMBER);
+  m_relay->Receive (packet, ip, Ptr<Ipv4Interface> ());
+}
+void
+SiftRelayDropTest::DoRun ()
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (200 * i, 0, 0));
+      nodes.Get (i)->AggregateObject (mobility);
+    }
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SiftHelper sift;
+  SiftMainHelper siftMain;
+  siftMain.Install (sift, nodes);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  m_interfaces = address.Assign (devices);
+  m_relay = nodes.Get (1)->GetObject<SiftRouting> ();
+  m_relay->TraceConnectWithoutContext ("HopLimitDrops", MakeCallback (&SiftRelayDropTest::HopLimitDrops, this));
+  m_relay->TraceConnectWithoutContext ("DropReason", MakeCallback (&SiftRelayDropTest::Drop, this));
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext (
+    "Tx", MakeCallback (&SiftRelayDropTest::Tx, this));
+
+  // A packet without a hop left is dropped once, however many copies of it the relay hears
+  Simulator::Schedule (Seconds (1), &SiftRelayDropTest::ReceiveAtRelay, this, 1, 1, 0);
+  Simulator::Schedule (Seconds (1.001), &SiftRelayDropTest::ReceiveAtRelay, this, 1, 1, 0);
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ttlDrops, 1, "One drop for two copies");
+  NS_TEST_EXPECT_MSG_EQ (m_hopLimitDrops, 1, "One packet counted");
+  NS_TEST_EXPECT_MSG_EQ (m_tx, 0, "No contention timer, nothing forwarded");
+
+  // A packet with one hop left is forwarded with a TTL of 1
+  Simulator::Schedule (Seconds (0), &SiftRelayDropTest::ReceiveAtRelay, this, 2, 2, 0);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ttlDrops, 1, "Not dropped");
+  NS_TEST_EXPECT_MSG_EQ (m_hopLimitDrops, 1, "Not counted");
+  NS_TEST_EXPECT_MSG_EQ (m_tx, 1, "Forwarded");
+
+  // A packet whose trajectory passes 1000 m away is filtered once, however many copies the
+  // relay hears
+  Simulator::Schedule (Seconds (0), &SiftRelayDropTest::ReceiveAtRelay, this, 3, 64, 1000);
+  Simulator::Schedule (Seconds (0.001), &SiftRelayDropTest::ReceiveAtRelay, this, 3, 64, 1000);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_corridorDrops, 1, "One drop for two copies");
+  NS_TEST_EXPECT_MSG_EQ (m_ttlDrops, 1, "Not dropped for its TTL");
+  NS_TEST_EXPECT_MSG_EQ (m_tx, 1, "Not forwarded");
+  m_relay = 0;
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+class SiftTrajectoryCacheTest : public TestCase
+{
+public:
+  SiftTrajectoryCacheTest ();
+  ~SiftTrajectoryCacheTest ();
+  virtual void
+  DoRun (void);
+  void Tx (const SiftHeader &header);
+  /**
+   * \brief Send a packet from node 0.
+   * \param destination index of the destination node
+   */
+  void Send (uint32_t destination);
+  /**
+   * \param x new x coordinate of the source
+   */
+  void MoveSource (double x);
+  /**
+   * \brief Check the header of the last packet sent.
+   * \param lastSourceX x coordinate of the source the header was built with
+   * \param destX x coordinate of the destination the header was built with
+   * \param cached number of cached trajectories
+   * \param message what is checked
+   */
+  void Check (int32_t lastSourceX, int32_t destX, uint32_t cached, std::string message);
+  NodeContainer m_nodes;               ///< the source and two destinations
+  Ipv4InterfaceContainer m_interfaces; ///< their addresses
+  SiftHeader m_header;                 ///< header of the last packet sent
+};
+SiftTrajectoryCacheTest::SiftTrajectoryCacheTest ()
+  : TestCase ("SiFT trajectory cache of the source")
+{
+}
+SiftTrajectoryCacheTest::~SiftTrajectoryCacheTest ()
+{
+}
+void
+SiftTrajectoryCacheTest::Tx (const SiftHeader &header)
+{
+  m_header = header;
+}
+void
+SiftTrajectoryCacheTest::Send (uint32_t destination)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udpHeader;
+  packet->AddHeader (udpHeader);
+  m_nodes.Get (0)->GetObject<SiftRouting> ()->Send (packet, m_interfaces.GetAddress (0),
+                                                    m_interfaces.GetAddress (destination), 17, Ptr<Ipv4Route> ());
+}
+void
+SiftTrajectoryCacheTest::MoveSource (double x)
+{
+  m_nodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (x, 0, 0));
+}
+void
+SiftTrajectoryCacheTest::Check (int32_t lastSourceX, int32_t destX, uint32_t cached, std::string message)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_header.GetLastSourceXLoc (), lastSourceX, message << ", position of the source");
+  NS_TEST_EXPECT_MSG_EQ (m_header.GetDestXLoc (), destX, message << ", position of the destination");
+  NS_TEST_EXPECT_MSG_EQ (m_nodes.Get (0)->GetObject<SiftRouting> ()->GetNCachedTrajectories (), cached,
+                         message << ", cached trajectories");
+}
+void
+SiftTrajectoryCacheTest::DoRun ()
+{
+  // Node 1 drives away from the source at 50 m/s, node 2 stands still
+  m_nodes.Create (3);
+  const double x[] = { 0, 400, 0 };
+  const double y[] = { 0, 0, 400 };
+  for (uint32_t i = 0; i < m_nodes.GetN (); ++i)
+    {
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (x[i], y[i], 0));
+      m_nodes.Get (i)->AggregateObject (mobility);
+    }
+  m_nodes.Get (1)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (50, 0, 0));
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+  SiftHelper sift;
+  sift.Set ("TrajectoryCacheLifetime", TimeValue (Seconds (1)));
+  sift.Set ("TrajectoryCacheDistance", DoubleValue (10));
+  SiftMainHelper siftMain;
+  siftMain.Install (sift, m_nodes);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < m_nodes.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      m_nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  m_interfaces = address.Assign (devices);
+  Ptr<SiftRouting> source = m_nodes.Get (0)->GetObject<SiftRouting> ();
+  source->TraceConnectWithoutContext ("Tx", MakeCallback (&SiftTrajectoryCacheTest::Tx, this));
+
+  Simulator::Schedule (Seconds (1), &SiftTrajectoryCacheTest::Send, this, 1);
+  Simulator::Schedule (Seconds (1), &SiftTrajectoryCacheTest::Check, this, 0, 450, 1, "Built");
+  // The source moves less than TrajectoryCacheDistance, then more
+  Simulator::Schedule (Seconds (1.05), &SiftTrajectoryCacheTest::MoveSource, this, 5);
+  Simulator::Schedule (Seconds (1.1), &SiftTrajectoryCacheTest::Send, this, 1);
+  Simulator::Schedule (Seconds (1.1), &SiftTrajectoryCacheTest::Check, this, 0, 450, 1, "Hit within the lifetime");
+  Simulator::Schedule (Seconds (1.12), &SiftTrajectoryCacheTest::MoveSource, this, 20);
+  Simulator::Schedule (Seconds (1.15), &SiftTrajectoryCacheTest::Send, this, 1);
+  Simulator::Schedule (Seconds (1.15), &SiftTrajectoryCacheTest::Check, this, 20, 457, 1, "Rebuilt, the source moved");
+  // The destination is extrapolated 7.5 m, then 12.5 m from the header
+  Simulator::Schedule (Seconds (1.3), &SiftTrajectoryCacheTest::Send, this, 1);
+  Simulator::Schedule (Seconds (1.3), &SiftTrajectoryCacheTest::Check, this, 20, 457, 1, "Hit, the destination moved a little");
+  Simulator::Schedule (Seconds (1.4), &SiftTrajectoryCacheTest::Send, this, 1);
+  Simulator::Schedule (Seconds (1.4), &SiftTrajectoryCacheTest::Check, this, 20, 470, 1, "Rebuilt, the destination moved");
+  // Expired entries stay until the next header is built, at most once per lifetime
+  Simulator::Schedule (Seconds (1.5), &SiftTrajectoryCacheTest::Send, this, 2);
+  Simulator::Schedule (Seconds (1.5), &SiftTrajectoryCacheTest::Check, this, 20, 0, 2, "Another destination");
+  Simulator::Schedule (Seconds (2.55), &SiftTrajectoryCacheTest::Check, this, 20, 0, 2, "Nothing sent, nothing swept");
+  Simulator::Schedule (Seconds (2.6), &SiftTrajectoryCacheTest::Send, this, 2);
+  Simulator::Schedule (Seconds (2.6), &SiftTrajectoryCacheTest::Check, this, 20, 0, 1, "Expired entries swept");
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ ((source->m_state.FindGeographicTuple (m_interfaces.GetAddress (1)) == 0), true,
+                         "Destinations are not added to the geographic set of the source");
+  m_nodes = NodeContainer ();
+  Simulator::Destroy ();
+}
+// -----------------------------------------------------------------------------
+class SiftTestSuite : public TestSuite
+{
+public:
+  SiftTestSuite () : TestSuite ("routing-sift", UNIT)
+  {
+    AddTestCase (new SiftDuplicateCacheTest, TestCase::QUICK);
+    AddTestCase (new SiftSequenceWindowTest, TestCase::QUICK);
+    AddTestCase (new SiftBloomFilterTest, TestCase::QUICK);
+    AddTestCase (new SiftGeoTest, TestCase::QUICK);
+    AddTestCase (new SiftGeoGridTest, TestCase::QUICK);
+    AddTestCase (new SiftGeometryKernelTest, TestCase::QUICK);
+    AddTestCase (new SiftGeoPredictionTest, TestCase::QUICK);
+    AddTestCase (new SiftNodeRegistryTest, TestCase::QUICK);
+    AddTestCase (new SiftPositionOracleTest, TestCase::QUICK);
+    AddTestCase (new SiftBeaconHeaderTest, TestCase::QUICK);
+    AddTestCase (new SiftCompactHeaderTest, TestCase::QUICK);
+    AddTestCase (new SiftWaypointTest, TestCase::QUICK);
+    AddTestCase (new SiftRoadMapTest, TestCase::QUICK);
+    AddTestCase (new SiftDelayPolicyTest, TestCase::QUICK);
+    AddTestCase (new SiftSegmentDistanceTest, TestCase::QUICK);
+    AddTestCase (new SiftTimerCollisionTest, TestCase::QUICK);
+    AddTestCase (new SiftRelayDropTest, TestCase::QUICK);
+    AddTestCase (new SiftTrajectoryCacheTest, TestCase::QUICK);
+  }
+} g_siftTestSuite;
+} // namespace sift
+} // namespace ns3